@@ -0,0 +1,27 @@
+#version 330 core
+
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords> of the unit quad
+
+out vec2 TexCoords;
+
+uniform vec2 rectMin;       // World-space rectangle covered by the quad
+uniform vec2 rectSize;
+uniform vec2 scroll;        // Offset of the pattern, in world units
+uniform float parallax;     // 1 moves with the world, 0 stays fixed on screen
+uniform vec2 textureSize;   // World size of one copy of the texture
+uniform vec2 cameraPos;     // Top-left of the visible rectangle
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
+
+void main()
+{
+    vec2 worldPos = rectMin + vertex.xy * rectSize;
+    // with parallax below 1 the pattern lags behind the camera
+    TexCoords = (worldPos - cameraPos * (1.0 - parallax) + scroll) / textureSize;
+    gl_Position = projection * view * vec4(worldPos, 0.0, 1.0);
+}
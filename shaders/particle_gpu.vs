@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+// per instance, read straight from the simulation's state buffer
+layout (location = 1) in vec2 position;
+layout (location = 2) in float life;
+layout (location = 3) in float alpha;
+
+out vec2 TexCoords;
+out vec4 ParticleColor;
+
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
+
+uniform vec3  color;
+uniform float size;
+
+void main()
+{
+    // dead particles collapse to a point and cover no pixels
+    float scale = life > 0.0 ? size : 0.0;
+    TexCoords = vertex.zw;
+    ParticleColor = vec4(color, alpha);
+    gl_Position = projection * view * vec4((vertex.xy * scale) + position, 0.0, 1.0);
+}
@@ -1,13 +1,19 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+// per instance
+layout (location = 1) in vec2 offset;
+layout (location = 2) in vec4 color;
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
-uniform mat4 projection; // Projection matrix
-uniform mat4 view;       // View matrix
-uniform vec2 offset;
-uniform vec4 color;
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
 
 void main()
 {
@@ -15,4 +21,4 @@ void main()
     TexCoords = vertex.zw;
     ParticleColor = color;
     gl_Position = projection * view * vec4((vertex.xy * scale) + offset, 0.0, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,59 @@
+#version 330 core
+// Advances one particle per vertex; the outputs are captured with transform
+// feedback into the other state buffer, nothing is rasterized
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 velocity;
+layout (location = 2) in float life;
+layout (location = 3) in float alpha;
+
+out vec2  outPosition;
+out vec2  outVelocity;
+out float outLife;
+out float outAlpha;
+
+uniform float dt;
+uniform int   frame;            // reseeds the random numbers every step
+uniform vec2  origin;           // centre of the emission area
+uniform vec2  spread;           // size of the emission area
+uniform vec2  baseVelocity;
+uniform vec2  velocityJitter;
+uniform float lifetime;
+uniform float fade;             // alpha lost per second
+uniform float respawnChance;    // chance a dead particle is emitted this step
+
+uint hash(uint x)
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+// uniform random number in [0, 1) for this particle, step and purpose
+float random(uint salt)
+{
+    return float(hash(uint(gl_VertexID) * 8u + salt + hash(uint(frame))) >> 8u) / 16777216.0;
+}
+
+void main()
+{
+    float remaining = life - dt;
+    if (remaining > 0.0) {
+        outPosition = position - velocity * dt;
+        outVelocity = velocity;
+        outLife = remaining;
+        outAlpha = alpha - fade * dt;
+    } else if (random(0u) < respawnChance) {
+        outPosition = origin + (vec2(random(1u), random(2u)) - 0.5) * spread;
+        outVelocity = baseVelocity + (vec2(random(3u), random(4u)) - 0.5) * velocityJitter;
+        outLife = lifetime;
+        outAlpha = 1.0;
+    } else {
+        outPosition = position;
+        outVelocity = velocity;
+        outLife = 0.0;
+        outAlpha = 0.0;
+    }
+}
@@ -6,7 +6,14 @@ out vec2 TexCoords;
 uniform bool chaos;
 uniform bool confuse;
 uniform bool shake;
-uniform float time;
+
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
 
 void main()
 {
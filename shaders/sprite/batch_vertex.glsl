@@ -0,0 +1,23 @@
+#version 330 core
+
+layout (location = 0) in vec2 position;  // World-space position, transformed on the CPU
+layout (location = 1) in vec2 texCoords; // Final texture coordinates
+layout (location = 2) in vec3 color;     // Sprite tint
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
+
+void main()
+{
+    TexCoords = texCoords;
+    SpriteColor = color;
+    gl_Position = projection * view * vec4(position, 0.0, 1.0);
+}
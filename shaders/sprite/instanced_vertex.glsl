@@ -0,0 +1,29 @@
+#version 330 core
+
+layout (location = 0) in vec4 vertex;        // <vec2 position, vec2 texCoords> of the unit quad
+layout (location = 1) in vec2 axisX;         // Per instance: transformed x axis of the quad
+layout (location = 2) in vec2 axisY;         // Per instance: transformed y axis of the quad
+layout (location = 3) in vec2 translation;   // Per instance: world position of the quad's origin
+layout (location = 4) in vec2 textureOffset; // Per instance: offset of the texture region
+layout (location = 5) in vec2 textureSize;   // Per instance: size of the texture region
+layout (location = 6) in vec4 color;         // Per instance: sprite tint
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
+
+void main()
+{
+    TexCoords = vertex.zw * textureSize + textureOffset;
+    SpriteColor = color.rgb;
+
+    vec2 position = translation + axisX * vertex.x + axisY * vertex.y;
+    gl_Position = projection * view * vec4(position, 0.0, 1.0);
+}
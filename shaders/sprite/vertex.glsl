@@ -9,8 +9,13 @@ uniform vec2 textureOffset; // Offset for the texture
 uniform vec2 textureSize;   // Size of the texture region to sample
 
 uniform mat4 model;         // Model matrix
-uniform mat4 view;          // View matrix
-uniform mat4 projection;    // Projection matrix
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
 
 void main()
 {
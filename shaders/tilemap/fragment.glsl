@@ -0,0 +1,25 @@
+#version 330 core
+in vec2 WorldPos;
+out vec4 color;
+
+uniform sampler2D atlas;      // tiles.png
+uniform usampler2D tileIndex; // One texel per tile, 0 is empty
+uniform vec2 tileSize;        // World size of a tile
+uniform vec2 atlasTiles;      // Tiles across and down the atlas
+
+void main()
+{
+    vec2 cell = WorldPos / tileSize;
+    ivec2 coord = ivec2(floor(cell));
+    if (any(lessThan(coord, ivec2(0))) || any(greaterThanEqual(coord, textureSize(tileIndex, 0))))
+        discard;
+    uint id = texelFetch(tileIndex, coord, 0).r;
+    if (id == 0u)
+        discard;
+
+    uint across = uint(atlasTiles.x);
+    vec2 atlasCell = vec2(float((id - 1u) % across), float((id - 1u) / across));
+    vec2 uv = (atlasCell + fract(cell)) / atlasTiles;
+    // fract() jumps at tile edges; take the gradients from the continuous coordinate
+    color = textureGrad(atlas, uv, dFdx(cell) / atlasTiles, dFdy(cell) / atlasTiles);
+}
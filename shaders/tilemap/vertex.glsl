@@ -0,0 +1,21 @@
+#version 330 core
+
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords> of the unit quad
+
+out vec2 WorldPos;
+
+uniform vec2 rectMin;       // World-space rectangle covered by the quad
+uniform vec2 rectSize;
+layout (std140) uniform FrameData
+{
+    mat4  projection;       // Projection matrix
+    mat4  view;             // View matrix, from Camera
+    vec2  viewportSize;
+    float time;             // Seconds since start
+};
+
+void main()
+{
+    WorldPos = rectMin + vertex.xy * rectSize;
+    gl_Position = projection * view * vec4(WorldPos, 0.0, 1.0);
+}
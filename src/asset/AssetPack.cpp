@@ -0,0 +1,184 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "util/Lz4.h"
+#include "util/Util.h"
+
+static_assert(sizeof(AssetPack::Header) == 16, "pack header must not change size");
+static_assert(sizeof(AssetPack::Entry) == 32, "pack entry must not change size");
+
+bool AssetPack::Open(const std::string &path)
+{
+    this->Close();
+    if (!this->file.Open(path))
+        return false;
+    const unsigned char *data = this->file.Data();
+    size_t size = this->file.Size();
+    Header header;
+    if (size < sizeof(Header)) {
+        this->Close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    size_t tableEnd = sizeof(Header) + static_cast<size_t>(header.Count) * sizeof(Entry) + header.NamesSize;
+    if (std::memcmp(header.Magic, "NMPK", 4) != 0 || header.Version != VERSION || size < tableEnd) {
+        std::cerr << "Invalid asset pack: " << path << std::endl;
+        this->Close();
+        return false;
+    }
+    // entries sit right after the 16-byte header, so the mapping keeps them aligned
+    this->entries = reinterpret_cast<const Entry *>(data + sizeof(Header));
+    this->names = reinterpret_cast<const char *>(data + sizeof(Header) + header.Count * sizeof(Entry));
+    this->count = header.Count;
+    for (uint32_t i = 0; i < this->count; ++i) {
+        const Entry &entry = this->entries[i];
+        if (entry.Offset + entry.Size > size || entry.NameOffset + entry.NameLength > header.NamesSize) {
+            std::cerr << "Invalid asset pack: " << path << std::endl;
+            this->Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::Close()
+{
+    this->file.Close();
+    this->entries = nullptr;
+    this->names = nullptr;
+    this->count = 0;
+}
+
+const AssetPack::Entry *AssetPack::find(const std::string &name) const
+{
+    uint64_t hash = hashBytes(name.data(), name.size());
+    const Entry *end = this->entries + this->count;
+    const Entry *it = std::lower_bound(this->entries, end, hash,
+                                       [](const Entry &entry, uint64_t value) { return entry.NameHash < value; });
+    for (; it != end && it->NameHash == hash; ++it) {
+        if (it->NameLength == name.size() && std::memcmp(this->names + it->NameOffset, name.data(), name.size()) == 0)
+            return it;
+    }
+    return nullptr;
+}
+
+bool AssetPack::Read(const std::string &name, AssetData &out) const
+{
+    const Entry *entry = this->find(name);
+    if (!entry)
+        return false;
+    const unsigned char *stored = this->file.Data() + entry->Offset;
+    if (entry->Compression == COMPRESSION_NONE) {
+        out.data = stored;
+        out.size = entry->Size;
+        out.valid = true;
+        return true;
+    }
+    out.buffer.resize(entry->RawSize);
+    if (entry->Compression != COMPRESSION_LZ4
+        || !lz4Decompress(stored, entry->Size, out.buffer.data(), out.buffer.size())) {
+        std::cerr << "Corrupt asset in pack: " << name << std::endl;
+        out.buffer.clear();
+        return false;
+    }
+    out.data = out.buffer.data();
+    out.size = out.buffer.size();
+    out.valid = true;
+    return true;
+}
+
+std::vector<std::string> AssetPack::List(const std::string &prefix) const
+{
+    std::vector<std::string> result;
+    for (uint32_t i = 0; i < this->count; ++i) {
+        std::string name(this->names + this->entries[i].NameOffset, this->entries[i].NameLength);
+        if (name.compare(0, prefix.size(), prefix) == 0)
+            result.push_back(name);
+    }
+    return result;
+}
+
+bool AssetPack::ReadLoose(const std::string &path, AssetData &out)
+{
+    if (!out.file.Open(path))
+        return false;
+    out.data = out.file.Data();
+    out.size = out.file.Size();
+    out.valid = true;
+    return true;
+}
+
+bool AssetPack::Write(const std::string &path, const std::vector<std::pair<std::string, std::string>> &files, bool compress)
+{
+    std::vector<Entry> table;
+    std::string nameBlock;
+    std::vector<std::vector<uint8_t>> payloads;
+    for (const auto &file : files) {
+        MappedFile source;
+        if (!source.Open(file.second)) {
+            std::cerr << "Could not read " << file.second << " for " << path << std::endl;
+            return false;
+        }
+        Entry entry = {};
+        entry.NameHash = hashBytes(file.first.data(), file.first.size());
+        entry.NameOffset = static_cast<uint32_t>(nameBlock.size());
+        entry.NameLength = static_cast<uint16_t>(file.first.size());
+        entry.RawSize = static_cast<uint32_t>(source.Size());
+        nameBlock += file.first;
+
+        std::vector<uint8_t> payload;
+        if (compress && source.Size() > 0)
+            payload = lz4Compress(source.Data(), source.Size());
+        // already-compressed formats (PNG) don't shrink; keep those viewable in place
+        if (payload.empty() || payload.size() + payload.size() / 8 >= source.Size()) {
+            payload.assign(source.Data(), source.Data() + source.Size());
+            entry.Compression = COMPRESSION_NONE;
+        } else {
+            entry.Compression = COMPRESSION_LZ4;
+        }
+        entry.Size = static_cast<uint32_t>(payload.size());
+        table.push_back(entry);
+        payloads.push_back(std::move(payload));
+    }
+
+    // payloads follow the tables, in input order; align each to 16 bytes so
+    // in-place views of binary assets (levels, cooked textures) stay aligned
+    uint64_t offset = sizeof(Header) + table.size() * sizeof(Entry) + nameBlock.size();
+    for (size_t i = 0; i < table.size(); ++i) {
+        offset = (offset + 15) & ~uint64_t(15);
+        table[i].Offset = offset;
+        offset += table[i].Size;
+    }
+    std::vector<size_t> order(table.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return table[a].NameHash < table[b].NameHash; });
+
+    Header header;
+    std::memcpy(header.Magic, "NMPK", 4);
+    header.Version = VERSION;
+    header.Count = static_cast<uint32_t>(table.size());
+    header.NamesSize = static_cast<uint32_t>(nameBlock.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (size_t i : order)
+        out.write(reinterpret_cast<const char *>(&table[i]), sizeof(Entry));
+    out.write(nameBlock.data(), static_cast<std::streamsize>(nameBlock.size()));
+    uint64_t written = sizeof(Header) + table.size() * sizeof(Entry) + nameBlock.size();
+    static const char zeros[16] = {};
+    for (size_t i = 0; i < table.size(); ++i) {
+        out.write(zeros, static_cast<std::streamsize>(table[i].Offset - written));
+        out.write(reinterpret_cast<const char *>(payloads[i].data()), static_cast<std::streamsize>(payloads[i].size()));
+        written = table[i].Offset + table[i].Size;
+    }
+    if (!out) {
+        std::cerr << "Could not write asset pack: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util/MappedFile.h"
+
+// Bytes of one asset, wherever they came from: a mapping of a loose file,
+// a view into a pack's mapping, or a decompressed copy.
+class AssetData
+{
+public:
+    const unsigned char *Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsValid() const { return valid; }
+
+private:
+    friend class AssetPack;
+    MappedFile                 file;
+    std::vector<unsigned char> buffer;
+    const unsigned char       *data = nullptr;
+    size_t                     size = 0;
+    bool                       valid = false;
+};
+
+// Read-only archive of game assets, mapped once at startup:
+//
+//     Header                         16 bytes
+//     Entry[Count]                   32 bytes each, sorted by NameHash
+//     names                          UTF-8, not terminated
+//     payload
+//
+// Names are paths relative to the resource root with '/' separators
+// ("textures/frog.png"). Entries are found with a binary search of the
+// hash; the stored name settles collisions. Payloads are stored as-is
+// or as one LZ4 block, whichever is smaller.
+class AssetPack
+{
+public:
+    static const uint32_t VERSION = 1;
+
+    enum Compression : uint8_t {
+        COMPRESSION_NONE = 0,
+        COMPRESSION_LZ4  = 1
+    };
+
+    struct Header
+    {
+        char     Magic[4];   // "NMPK"
+        uint32_t Version;
+        uint32_t Count;
+        uint32_t NamesSize;
+    };
+    struct Entry
+    {
+        uint64_t NameHash;
+        uint64_t Offset;     // from the start of the file
+        uint32_t Size;       // stored bytes
+        uint32_t RawSize;    // bytes once decompressed
+        uint32_t NameOffset; // into the names block
+        uint16_t NameLength;
+        uint8_t  Compression;
+        uint8_t  Reserved;
+    };
+
+    bool Open(const std::string &path);
+    void Close();
+    bool IsOpen() const { return file.IsOpen(); }
+
+    bool Contains(const std::string &name) const { return find(name) != nullptr; }
+    // Stored entries are viewed in place, compressed ones decompressed into
+    // out; safe to call from several threads
+    bool Read(const std::string &name, AssetData &out) const;
+    // Names of every entry starting with prefix
+    std::vector<std::string> List(const std::string &prefix = "") const;
+
+    // Maps a loose file into out; here so both sources fill the same type
+    static bool ReadLoose(const std::string &path, AssetData &out);
+
+    // Builds a pack from (name, source file) pairs
+    static bool Write(const std::string &path, const std::vector<std::pair<std::string, std::string>> &files,
+                      bool compress = true);
+
+private:
+    MappedFile   file;
+    const Entry *entries = nullptr;
+    const char  *names = nullptr;
+    uint32_t     count = 0;
+
+    const Entry *find(const std::string &name) const;
+};
+
+#endif
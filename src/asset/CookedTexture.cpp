@@ -0,0 +1,87 @@
+#include "CookedTexture.h"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(sizeof(CookedTexture::Header) == 48, "cooked texture header must not change size");
+
+unsigned int CookedTexture::LevelCount(unsigned int width, unsigned int height)
+{
+    unsigned int levels = 1;
+    while (width > 1 || height > 1) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        levels++;
+    }
+    return levels;
+}
+
+size_t CookedTexture::ChainBytes(unsigned int width, unsigned int height, unsigned int channels, unsigned int levels)
+{
+    size_t bytes = 0;
+    for (unsigned int level = 0; level < levels; ++level) {
+        bytes += static_cast<size_t>(width) * height * channels;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes;
+}
+
+// halves a level with a 2x2 box filter; odd edges repeat their last texel
+static void downsample(const unsigned char *src, unsigned int width, unsigned int height,
+                       unsigned int channels, unsigned char *dst)
+{
+    unsigned int dstWidth = width > 1 ? width / 2 : 1;
+    unsigned int dstHeight = height > 1 ? height / 2 : 1;
+    for (unsigned int y = 0; y < dstHeight; ++y) {
+        unsigned int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (unsigned int x = 0; x < dstWidth; ++x) {
+            unsigned int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            for (unsigned int c = 0; c < channels; ++c) {
+                unsigned int sum = src[(y0 * width + x0) * channels + c] + src[(y0 * width + x1) * channels + c]
+                                 + src[(y1 * width + x0) * channels + c] + src[(y1 * width + x1) * channels + c];
+                dst[(y * dstWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+std::vector<unsigned char> CookedTexture::Cook(const unsigned char *pixels, unsigned int width, unsigned int height,
+                                               unsigned int channels, uint64_t sourceSize, int64_t sourceTime,
+                                               uint64_t sourceHash)
+{
+    Header header = {};
+    std::memcpy(header.Magic, "NMTX", 4);
+    header.Version = VERSION;
+    header.Width = width;
+    header.Height = height;
+    header.Channels = channels;
+    header.Levels = LevelCount(width, height);
+    header.SourceSize = sourceSize;
+    header.SourceTime = sourceTime;
+    header.SourceHash = sourceHash;
+
+    std::vector<unsigned char> file(sizeof(Header) + ChainBytes(width, height, channels, header.Levels));
+    std::memcpy(file.data(), &header, sizeof(header));
+    unsigned char *level = file.data() + sizeof(Header);
+    std::memcpy(level, pixels, static_cast<size_t>(width) * height * channels);
+    for (unsigned int i = 1; i < header.Levels; ++i) {
+        unsigned char *next = level + static_cast<size_t>(width) * height * channels;
+        downsample(level, width, height, channels, next);
+        level = next;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return file;
+}
+
+bool CookedTexture::Parse(const unsigned char *data, size_t size, Header &header)
+{
+    if (size < sizeof(Header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.Magic, "NMTX", 4) != 0 || header.Version != VERSION
+        || (header.Channels != 3 && header.Channels != 4) || header.Levels != LevelCount(header.Width, header.Height))
+        return false;
+    return size >= sizeof(Header) + ChainBytes(header.Width, header.Height, header.Channels, header.Levels);
+}
@@ -0,0 +1,43 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// File format of a cooked texture, shared by the runtime TextureCache and
+// the offline cooker: a Header followed by the full mip chain, level 0
+// first, rows tightly packed. Needs no GL, so the cooker can link it.
+class CookedTexture
+{
+public:
+    static const uint32_t VERSION = 1;
+
+    struct Header
+    {
+        char     Magic[4];      // "NMTX"
+        uint32_t Version;
+        uint32_t Width, Height;
+        uint32_t Channels;      // 3 or 4, as decoded
+        uint32_t Levels;
+        uint64_t SourceSize;
+        int64_t  SourceTime;
+        uint64_t SourceHash;
+    };
+
+    // Builds the file for decoded pixels, mips included
+    static std::vector<unsigned char> Cook(const unsigned char *pixels, unsigned int width, unsigned int height,
+                                           unsigned int channels, uint64_t sourceSize, int64_t sourceTime,
+                                           uint64_t sourceHash);
+    // Checks data holds a complete cooked texture and reads its header
+    static bool Parse(const unsigned char *data, size_t size, Header &header);
+
+    // Bytes taken by a mip chain of the given size
+    static size_t ChainBytes(unsigned int width, unsigned int height, unsigned int channels, unsigned int levels);
+    static unsigned int LevelCount(unsigned int width, unsigned int height);
+
+private:
+    CookedTexture() { }
+};
+
+#endif
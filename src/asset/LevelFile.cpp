@@ -0,0 +1,123 @@
+#include "LevelFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static_assert(sizeof(LevelFile::Header) == 24, "level header must not change size");
+
+static size_t tileBytes(const LevelFile::Header &header)
+{
+    return static_cast<size_t>(header.Width) * header.Height * header.Layers * sizeof(uint16_t);
+}
+
+static size_t solidBytes(const LevelFile::Header &header)
+{
+    return (static_cast<size_t>(header.Width) * header.Height + 7) / 8;
+}
+
+bool LevelFile::Open(AssetData &&data)
+{
+    this->Close();
+    this->file = std::move(data);
+    if (this->file.Size() < sizeof(Header)) {
+        this->Close();
+        return false;
+    }
+    Header read;
+    std::memcpy(&read, this->file.Data(), sizeof(read));
+    if (std::memcmp(read.Magic, "NMLV", 4) != 0 || read.Version != VERSION || read.Layers == 0
+        || this->file.Size() < sizeof(Header) + tileBytes(read) + solidBytes(read)) {
+        std::cerr << "Invalid level file" << std::endl;
+        this->Close();
+        return false;
+    }
+    this->header = read;
+    return true;
+}
+
+const uint16_t *LevelFile::Layer(unsigned int layer) const
+{
+    if (layer >= this->header.Layers)
+        return nullptr;
+    // the header keeps the tile data 4-byte aligned within the page-aligned mapping
+    const uint16_t *tiles = reinterpret_cast<const uint16_t *>(this->file.Data() + sizeof(Header));
+    return tiles + static_cast<size_t>(layer) * this->header.Width * this->header.Height;
+}
+
+const uint8_t *LevelFile::solidBits() const
+{
+    return this->file.Data() + sizeof(Header) + tileBytes(this->header);
+}
+
+bool LevelFile::IsSolid(unsigned int row, unsigned int col) const
+{
+    if (row >= this->header.Height || col >= this->header.Width)
+        return false;
+    size_t bit = static_cast<size_t>(row) * this->header.Width + col;
+    return (this->solidBits()[bit / 8] >> (bit % 8)) & 1;
+}
+
+std::vector<std::vector<unsigned int>> LevelFile::ParseText(const unsigned char *data, size_t size)
+{
+    std::vector<std::vector<unsigned int>> tileData;
+    std::istringstream file(std::string(reinterpret_cast<const char *>(data), size));
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::vector<unsigned int> row;
+        unsigned int tile;
+        while (stream >> tile) {
+            row.push_back(tile);
+        }
+        tileData.push_back(row);
+    }
+    return tileData;
+}
+
+bool LevelFile::Write(const std::string &path, const std::vector<std::vector<unsigned int>> &rows)
+{
+    Header out = {};
+    std::memcpy(out.Magic, "NMLV", 4);
+    out.Version = VERSION;
+    out.Height = static_cast<uint32_t>(rows.size());
+    for (const auto &row : rows)
+        out.Width = std::max(out.Width, static_cast<uint32_t>(row.size()));
+    out.Layers = 1;
+
+    std::vector<uint16_t> tiles(static_cast<size_t>(out.Width) * out.Height, 0);
+    std::vector<uint8_t> solid(solidBytes(out), 0);
+    for (size_t row = 0; row < rows.size(); ++row) {
+        for (size_t col = 0; col < rows[row].size(); ++col) {
+            size_t cell = row * out.Width + col;
+            tiles[cell] = static_cast<uint16_t>(rows[row][col]);
+            if (DefaultSolid(rows[row][col]))
+                solid[cell / 8] |= static_cast<uint8_t>(1u << (cell % 8));
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&out), sizeof(out));
+    file.write(reinterpret_cast<const char *>(tiles.data()), static_cast<std::streamsize>(tiles.size() * sizeof(uint16_t)));
+    file.write(reinterpret_cast<const char *>(solid.data()), static_cast<std::streamsize>(solid.size()));
+    if (!file) {
+        std::cerr << "Could not write level file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LevelFile::Convert(const std::string &textPath, const std::string &binaryPath)
+{
+    AssetData text;
+    if (!AssetPack::ReadLoose(textPath, text)) {
+        std::cerr << "Could not open the file: " << textPath << std::endl;
+        return false;
+    }
+    std::vector<std::vector<unsigned int>> rows = ParseText(text.Data(), text.Size());
+    if (rows.empty())
+        return false;
+    return Write(binaryPath, rows);
+}
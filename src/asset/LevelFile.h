@@ -0,0 +1,64 @@
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+// Binary level (.lvlb), read in place from a memory mapping or the asset pack:
+//
+//     Header                      24 bytes
+//     uint16 tiles[Layers][Height][Width]
+//     uint8  solid[(Width * Height + 7) / 8]   bit (row * Width + col), LSB first
+//
+// All values are little-endian. Tile 0 is an empty cell; only layer 0 is
+// drawn today, further layers ride along for later use. Needs no GL or
+// ResourceManager, so the cooker links it too.
+class LevelFile
+{
+public:
+    static const uint32_t VERSION = 1;
+
+    struct Header
+    {
+        char     Magic[4];   // "NMLV"
+        uint32_t Version;
+        uint32_t Width, Height;
+        uint32_t Layers;
+        uint32_t Reserved;
+    };
+
+    // takes over the bytes of a .lvlb (see ResourceManager::ReadAsset) and
+    // validates them; false if they're malformed
+    bool Open(AssetData &&data);
+    void Close() { file = AssetData(); header = Header(); }
+
+    unsigned int Width() const { return header.Width; }
+    unsigned int Height() const { return header.Height; }
+    unsigned int Layers() const { return header.Layers; }
+    // Width() * Height() tile IDs, row-major
+    const uint16_t *Layer(unsigned int layer) const;
+    bool IsSolid(unsigned int row, unsigned int col) const;
+
+    // Solidity the text format implies: everything but the floor tile
+    static bool DefaultSolid(unsigned int tileId) { return tileId != 40; }
+
+    // Parses the whitespace-separated text format, one row per line; rows
+    // may be ragged
+    static std::vector<std::vector<unsigned int>> ParseText(const unsigned char *data, size_t size);
+    // Writes a single-layer level from text-format rows, padding ragged
+    // rows with empty tiles
+    static bool Write(const std::string &path, const std::vector<std::vector<unsigned int>> &rows);
+    // Converts a loose text level to binary
+    static bool Convert(const std::string &textPath, const std::string &binaryPath);
+
+private:
+    AssetData  file;
+    Header     header = Header();
+
+    const uint8_t *solidBits() const;
+};
+
+#endif
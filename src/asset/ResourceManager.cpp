@@ -6,13 +6,26 @@
 #include <fstream>
 
 #include "util/Util.h"
+#include "render/GLState.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "TextureResidency.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
-std::map<std::string, Shader> ResourceManager::Shaders;
+ResourceRegistry<Shader> ResourceManager::Shaders;
 std::map<std::string, Texture1D> ResourceManager::Textures1D;
-std::map<std::string, std::shared_ptr<Texture2D>> ResourceManager::Textures2D;
+ResourceRegistry<std::shared_ptr<Texture2D>> ResourceManager::Textures2D;
 std::map<std::string, Texture3D> ResourceManager::Textures3D;
+TextureAtlas ResourceManager::Atlas;
+AssetPack ResourceManager::Pack;
+#ifdef LOOSE_ASSETS
+bool ResourceManager::LooseFirst = true;
+#else
+bool ResourceManager::LooseFirst = false;
+#endif
+std::vector<std::pair<std::string, ShaderCache::Source>> ResourceManager::queuedShaders;
+StringArena ResourceManager::paths;
 
 // Static member initialization
 std::string ResourceManager::root = "";
@@ -20,9 +33,8 @@ std::string ResourceManager::root = "";
 // Implement full path handling for shaders and textures
 const char *ResourceManager::GetFullPath(const std::string &filename)
 {
-    char *buffer = new char[BUFFER_SIZE];
-    std::strcpy(buffer, (filename).c_str());
-    return buffer;
+    // the same few paths are built over and over, so they're stored once
+    return paths.Intern(filename);
 }
 const char *ResourceManager::GetModelPath(const std::string &filename)
 {
@@ -59,17 +71,70 @@ Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderF
     {
         fShaderFile = GetShaderPath(fShaderFile);
     }
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+    return *Shaders.Get(Shaders.Set(name, loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile)));
+}
+void ResourceManager::QueueShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+{
+    if (!includes(vShaderFile, ":"))
+    {
+        vShaderFile = GetShaderPath(vShaderFile);
+    }
+    if (!includes(fShaderFile, ":"))
+    {
+        fShaderFile = GetShaderPath(fShaderFile);
+    }
+    queuedShaders.emplace_back(name, readShaderFiles(vShaderFile, fShaderFile, gShaderFile));
+}
+void ResourceManager::LoadQueuedShaders()
+{
+    std::vector<ShaderCache::Source> sources;
+    sources.reserve(queuedShaders.size());
+    for (auto &queued : queuedShaders)
+    {
+        sources.push_back(std::move(queued.second));
+    }
+    std::vector<Shader> shaders = ShaderCache::Build(sources);
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        Shaders.Set(queuedShaders[i].first, shaders[i]);
+    }
+    queuedShaders.clear();
 }
 
-Shader ResourceManager::GetShader(std::string name)
+Shader &ResourceManager::LoadFeedbackShader(const char *vShaderFile, const std::vector<const char *> &varyings, std::string name)
+{
+    if (!includes(vShaderFile, ":"))
+    {
+        vShaderFile = GetShaderPath(vShaderFile);
+    }
+    AssetData data;
+    if (!ReadAsset(vShaderFile, data))
+    {
+        o << std::string("ERROR::SHADER: Failed to read shader file ") + vShaderFile;
+    }
+    std::string code(reinterpret_cast<const char *>(data.Data()), data.Size());
+    Shader shader;
+    shader.CompileFeedback(code.c_str(), varyings);
+    return *Shaders.Get(Shaders.Set(name, shader));
+}
+ShaderHandle ResourceManager::FindShader(const std::string &name)
+{
+    ShaderHandle handle = Shaders.Find(name);
+    return handle.IsValid() ? handle : Shaders.Set(name, Shader());
+}
+Shader &ResourceManager::GetShader(const std::string &name)
+{
+    return *Shaders.Get(FindShader(name));
+}
+Shader &ResourceManager::GetShader(ShaderHandle handle)
 {
-    return Shaders[name];
+    static Shader missing;
+    Shader *shader = Shaders.Get(handle);
+    return shader ? *shader : missing;
 }
-Shader *ResourceManager::ShaderP(std::string &name)
+Shader *ResourceManager::ShaderP(const std::string &name)
 {
-    return &Shaders[name]; // Assuming Shaders is a map or similar structure
+    return &GetShader(name);
 }
 
 Texture1D ResourceManager::LoadTexture1D(const char *file, bool alpha, std::string name,
@@ -95,30 +160,65 @@ Texture2D ResourceManager::LoadTexture2D(const char *file, std::string name, boo
         file = GetTexturePath(file);
     }
     auto ptr = std::make_shared<Texture2D>(loadTexture2DFromFile(file, alpha, sWrap, tWrap, minFilter, magFilter));
-    Textures2D[file] = ptr;
+    TextureResidency::Track(ptr, file, alpha);
+    Textures2D.Set(file, ptr);
     if(file != name){
-        Textures2D[name] = ptr;
+        Textures2D.Set(name, ptr);
     }
     return *ptr;
 }
 
-Texture2D ResourceManager::GetTexture2D(std::string name)
+std::shared_ptr<Texture2D> ResourceManager::LoadTexture2DAsync(const char *file, std::string name, bool alpha, GLint sWrap, GLint tWrap, GLint minFilter, GLint magFilter)
 {
-    if (Textures2D.find(name) == Textures2D.end())
+    if (name.empty())
+    {
+        name = file;
+    }
+    if (!includes(file, ":"))
+    {
+        file = GetTexturePath(file);
+    }
+    auto ptr = TextureLoader::LoadAsync(file, alpha, sWrap, tWrap, minFilter, magFilter);
+    Textures2D.Set(file, ptr);
+    if(file != name){
+        Textures2D.Set(name, ptr);
+    }
+    return ptr;
+}
+
+TextureHandle ResourceManager::FindTexture(const std::string &name)
+{
+    TextureHandle handle = Textures2D.Find(name);
+    if (!handle.IsValid())
     {
         LoadTexture2D(name.c_str(), "");
+        handle = Textures2D.Find(name);
     }
-    return *Textures2D[name];
+    return handle;
+}
+Texture2D &ResourceManager::GetTexture2D(const std::string &name)
+{
+    return GetTexture2D(FindTexture(name));
 }
-Texture2D *ResourceManager::GetTexture(std::string name)
+Texture2D &ResourceManager::GetTexture2D(TextureHandle handle)
 {
-    auto it = Textures2D.find(name);
-    if (it != Textures2D.end())
+    static Texture2D missing;
+    std::shared_ptr<Texture2D> *texture = Textures2D.Get(handle);
+    if (!texture || !*texture)
+    {
+        return missing;
+    }
+    // callers read the texture, so it has to be complete by now
+    if ((*texture)->status == 0)
     {
-        // Return the raw pointer from the shared_ptr without creating a new instance
-        return it->second.get(); // Use .get() to get the raw pointer
+        TextureLoader::Wait(*texture);
     }
-    return nullptr; // Texture not found
+    return **texture;
+}
+Texture2D *ResourceManager::GetTexture(const std::string &name)
+{
+    std::shared_ptr<Texture2D> *texture = Textures2D.Get(name);
+    return texture ? texture->get() : nullptr; // Texture not found
 }
 
 Texture3D ResourceManager::LoadTexture3D(const char *file, bool alpha, std::string name,
@@ -133,9 +233,38 @@ Texture3D ResourceManager::GetTexture3D(std::string name)
 {
     return Textures3D[name];
 }
+void ResourceManager::BuildAtlas(const std::vector<std::string> &files, unsigned int pageSize, unsigned int padding)
+{
+    size_t firstPage = Atlas.Pages().size();
+    for (const std::string &file : files)
+    {
+        const char *path = includes(file.c_str(), ":") ? file.c_str() : GetTexturePath(file);
+        Atlas.Add(file, path);
+    }
+    Atlas.Build(pageSize, padding);
+    for (size_t i = firstPage; i < Atlas.Pages().size(); ++i)
+    {
+        Textures2D.Set("atlas_page" + std::to_string(i), Atlas.Pages()[i]);
+        TextureResidency::Track(Atlas.Pages()[i], "", true);
+    }
+    o << "Packed " + std::to_string(files.size()) + " textures into " + std::to_string(Atlas.Pages().size() - firstPage) + " atlas page(s)";
+}
+const AtlasRegion *ResourceManager::GetAtlasRegion(const std::string &name)
+{
+    return Atlas.Find(name);
+}
 std::shared_ptr<Texture2D> ResourceManager::GetTexture2DByIndex(size_t index)
 {
-    static std::vector<std::shared_ptr<Texture2D>> textureList = ConvertMapToList(Textures2D);
+    static std::vector<std::shared_ptr<Texture2D>> textureList;
+    if (textureList.empty())
+    {
+        Textures2D.ForEach([](const char *, std::shared_ptr<Texture2D> &texture) {
+            if (texture)
+            {
+                textureList.push_back(texture);
+            }
+        });
+    }
 
     if (index >= textureList.size())
     {
@@ -149,27 +278,47 @@ void ResourceManager::LoadAllTexturesFromDirectory()
 {
     namespace fs = std::filesystem;
 
-    // Iterate over files in the directory
-    for (const auto &entry : fs::directory_iterator(ResourceManager::root + "/textures"))
+    // Loose files first, then whatever only the pack has
+    std::vector<fs::path> files;
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(GetTexturePath(""), error))
     {
-        std::string path = entry.path().string();
+        files.push_back(entry.path());
+    }
+    for (const std::string &name : Pack.List("textures/"))
+    {
+        // images the cooker packed only as "<image>.tex" load through the cooked copy
+        fs::path path(name);
+        files.push_back(path.extension() == ".tex" ? path.replace_extension() : path);
+    }
 
+    for (const fs::path &path : files)
+    {
         // Filter image files based on extension (e.g., png, jpg, jpeg)
-        if (entry.path().extension() == ".png" || entry.path().extension() == ".jpg" || entry.path().extension() == ".jpeg")
+        if (path.extension() == ".png" || path.extension() == ".jpg" || path.extension() == ".jpeg")
         {
-            std::string filename = entry.path().stem().string(); // File name without extension
-
-            // Load texture and add to the map
-            ResourceManager::LoadTexture2D(path.c_str(), filename);
-            o << "Loaded texture: " << filename << " from path: " << path;
+            std::string file = path.filename().string();
+            std::string stem = path.stem().string(); // File name without extension
+            // Atlas members are drawn from their page, don't decode them twice
+            if (Textures2D.Find(file).IsValid() || Atlas.Find(file))
+            {
+                continue;
+            }
+
+            // Queue the decode; the texture is usable by name right away
+            auto ptr = ResourceManager::LoadTexture2DAsync(file.c_str());
+            Textures2D.Set(stem, ptr);
+            o << "Queued texture: " + stem + " from path: " + path.string();
         }
     }
 }
 void ResourceManager::Clear() {
     // Clear shaders
-    for (auto& iter : Shaders) {
-        glDeleteProgram(iter.second.ID);
-    }
+    Shaders.ForEach([](const char *, Shader &shader) {
+        GLState::ForgetProgram(shader.ID);
+        glDeleteProgram(shader.ID);
+    });
+    Shaders.Clear();
 
     // Clear 1D textures
     for (auto& iter : Textures1D) {
@@ -177,50 +326,123 @@ void ResourceManager::Clear() {
     }
 
     // Clear 2D textures
-    for (auto& iter : Textures2D) {
-        if (iter.second) { // Check if the shared_ptr is valid
-            glDeleteTextures(1, &iter.second->ID); // Use -> for dereferencing
+    // A texture registered under several names is deleted once
+    std::vector<Texture2D *> deleted;
+    Textures2D.ForEach([&deleted](const char *, std::shared_ptr<Texture2D> &texture) {
+        if (texture && std::find(deleted.begin(), deleted.end(), texture.get()) == deleted.end()) {
+            GLState::ForgetTexture(texture->ID);
+            glDeleteTextures(1, &texture->ID);
+            deleted.push_back(texture.get());
         }
-    }
+    });
+    Textures2D.Clear();
+    TextureResidency::Clear();
 
     // Clear 3D textures
     for (auto& iter : Textures3D) {
         glDeleteTextures(1, &iter.second.ID);
     }
+
+    // The atlas pages were deleted with the 2D textures
+    Atlas.Clear();
+    paths.Clear();
 }
 Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
 {
-    std::string vertexCode, fragmentCode, geometryCode;
-    try
-    {
-        std::ifstream vertexShaderFile(vShaderFile);
-        std::ifstream fragmentShaderFile(fShaderFile);
-        std::stringstream vShaderStream, fShaderStream;
-        vShaderStream << vertexShaderFile.rdbuf();
-        fShaderStream << fragmentShaderFile.rdbuf();
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        if (gShaderFile != nullptr)
+    return ShaderCache::Build({ readShaderFiles(vShaderFile, fShaderFile, gShaderFile) })[0];
+}
+
+ShaderCache::Source ResourceManager::readShaderFiles(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
+{
+    auto read = [](const char *file, std::string &code)
+    {
+        AssetData data;
+        if (!ReadAsset(file, data))
         {
-            std::ifstream geometryShaderFile(gShaderFile);
-            std::stringstream gShaderStream;
-            gShaderStream << geometryShaderFile.rdbuf();
-            geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
+            o << std::string("ERROR::SHADER: Failed to read shader file ") + file;
+            return;
         }
+        code.assign(reinterpret_cast<const char *>(data.Data()), data.Size());
+    };
+    ShaderCache::Source source;
+    read(vShaderFile, source.Vertex);
+    read(fShaderFile, source.Fragment);
+    if (gShaderFile != nullptr)
+    {
+        read(gShaderFile, source.Geometry);
+    }
+    source.HasGeometry = gShaderFile != nullptr;
+    return source;
+}
+
+bool ResourceManager::OpenPack(const std::string &path)
+{
+    if (!Pack.Open(path))
+    {
+        return false;
     }
-    catch (std::exception &e)
+    o << "Opened asset pack: " + path;
+    return true;
+}
+
+bool ResourceManager::ReadAsset(const std::string &path, AssetData &out)
+{
+    bool looseFirst = LooseFirst || !Pack.IsOpen();
+    if (looseFirst && AssetPack::ReadLoose(path, out))
     {
-        o << "ERROR::SHADER: Failed to read shader files";
+        return true;
     }
-    const char *vShaderCode = vertexCode.c_str();
-    const char *fShaderCode = fragmentCode.c_str();
-    const char *gShaderCode = geometryCode.c_str();
-    Shader shader;
-    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
-    return shader;
+    if (Pack.IsOpen())
+    {
+        // pack names are relative to root, with forward slashes
+        std::string name = path.compare(0, root.size(), root) == 0 ? path.substr(root.size()) : path;
+        std::replace(name.begin(), name.end(), '\\', '/');
+        while (!name.empty() && name[0] == '/')
+        {
+            name.erase(0, 1);
+        }
+        if (Pack.Read(name, out))
+        {
+            return true;
+        }
+    }
+    // not in the pack (or no pack); try the file system last
+    return !looseFirst && AssetPack::ReadLoose(path, out);
+}
+
+unsigned char *ResourceManager::DecodeImage(const char *file, int *width, int *height, int *channels, int desiredChannels)
+{
+    AssetData data;
+    if (ReadAsset(file, data))
+    {
+        return stbi_load_from_memory(data.Data(), static_cast<int>(data.Size()), width, height, channels, desiredChannels);
+    }
+
+    // the pack only ships the cooked copy of a texture; hand out its top level
+    TextureCache::Cooked cooked;
+    if (!TextureCache::Open(file, cooked))
+    {
+        return nullptr;
+    }
+    unsigned int wanted = desiredChannels > 0 ? static_cast<unsigned int>(desiredChannels) : cooked.Channels;
+    size_t texels = static_cast<size_t>(cooked.Width) * cooked.Height;
+    // allocated like stbi does, so callers keep freeing with stbi_image_free
+    unsigned char *pixels = static_cast<unsigned char *>(STBI_MALLOC(texels * wanted));
+    if (!pixels)
+    {
+        return nullptr;
+    }
+    for (size_t i = 0; i < texels; ++i)
+    {
+        for (unsigned int c = 0; c < wanted; ++c)
+        {
+            pixels[i * wanted + c] = c < cooked.Channels ? cooked.Pixels[i * cooked.Channels + c] : 255;
+        }
+    }
+    *width = static_cast<int>(cooked.Width);
+    *height = static_cast<int>(cooked.Height);
+    *channels = static_cast<int>(cooked.Channels);
+    return pixels;
 }
 
 Texture1D ResourceManager::loadTexture1DFromFile(const char *file, bool alpha,
@@ -232,8 +454,8 @@ Texture1D ResourceManager::loadTexture1DFromFile(const char *file, bool alpha,
         texture.Internal_Format = GL_RGBA;
         texture.Image_Format = GL_RGBA;
     }
-    int width, nrChannels;
-    unsigned char *data = stbi_load(file, &width, nullptr, &nrChannels, 0);
+    int width, height, nrChannels;
+    unsigned char *data = DecodeImage(file, &width, &height, &nrChannels, 0);
     texture.Wrap_S = sWrap;
     texture.Filter_Min = minFilter;
     texture.Filter_Max = magFilter;
@@ -245,25 +467,40 @@ Texture1D ResourceManager::loadTexture1DFromFile(const char *file, bool alpha,
 Texture2D ResourceManager::loadTexture2DFromFile(const char *file, bool alpha, GLint sWrap, GLint tWrap, GLint minFilter, GLint magFilter)
 {
     Texture2D texture;
+    texture.Wrap_S = sWrap;
+    texture.Wrap_T = tWrap;
+    texture.Filter_Min = minFilter;
+    texture.Filter_Max = magFilter;
+    UploadTexture2D(texture, file, alpha);
+    return texture;
+}
+
+bool ResourceManager::UploadTexture2D(Texture2D &texture, const char *file, bool alpha)
+{
+    // a cooked copy skips the decode and already has its mip chain
+    TextureCache::Cooked cooked;
+    if (TextureCache::Open(file, cooked))
+    {
+        texture.status = 1;
+        texture.Internal_Format = texture.Image_Format = cooked.Channels == 4 ? GL_RGBA : GL_RGB;
+        texture.GenerateLevels(cooked.Width, cooked.Height, cooked.Levels, cooked.Pixels);
+        return true;
+    }
 
     int width, height, nrChannels;
     // stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load(file, &width, &height, &nrChannels, 0);
+    unsigned char *data = DecodeImage(file, &width, &height, &nrChannels, 0);
     if (!data)
     {
         std::cerr << "Failed to load texture: " << file << std::endl;
         texture.status = -1;
-        return texture;
+        return false;
     }
     else
     {
         texture.status = 1;
     }
 
-    texture.Wrap_S = sWrap;
-    texture.Wrap_T = tWrap;
-    texture.Filter_Min = minFilter;
-    texture.Filter_Max = magFilter;
     if (alpha || nrChannels > 3)
     {
         texture.Internal_Format = GL_RGBA;
@@ -275,9 +512,10 @@ Texture2D ResourceManager::loadTexture2DFromFile(const char *file, bool alpha, G
         texture.Image_Format = GL_RGB;
     }
     texture.Generate(width, height, data);
+    TextureCache::Store(file, data, width, height, nrChannels);
 
     stbi_image_free(data);
-    return texture;
+    return true;
 }
 
 Texture3D ResourceManager::loadTexture3DFromFile(const char *file, bool alpha,
@@ -291,7 +529,7 @@ Texture3D ResourceManager::loadTexture3DFromFile(const char *file, bool alpha,
         texture.Image_Format = GL_RGBA;
     }
     int width, height, depth = 1, nrChannels;
-    unsigned char *data = stbi_load(file, &width, &height, &nrChannels, 0);
+    unsigned char *data = DecodeImage(file, &width, &height, &nrChannels, 0);
     texture.Wrap_S = sWrap;
     texture.Wrap_T = tWrap;
     texture.Wrap_R = rWrap;
@@ -23,10 +23,16 @@
 #include "Texture1D.h"
 #include "Texture2D.h"
 #include "Texture3D.h"
+#include "TextureAtlas.h"
+#include "ResourceRegistry.h"
+#include "AssetPack.h"
 #include "render/Shader.h"
+#include "render/ShaderCache.h"
 #include "util/Log.h"
+#include "util/StringArena.h"
 
-#define BUFFER_SIZE 1024
+typedef ResourceHandle<Shader> ShaderHandle;
+typedef ResourceHandle<std::shared_ptr<Texture2D>> TextureHandle;
 
 class ResourceManager
 {
@@ -34,17 +40,29 @@ public:
     // File path root for resources
     static std::string root;
 
-    // Resource maps
-    static std::map<std::string, Shader>    Shaders;
+    // Resource registries; shaders and 2D textures are looked up every
+    // frame, so they are resolved once to a handle (FindShader/FindTexture)
+    static ResourceRegistry<Shader>                     Shaders;
     static std::map<std::string, Texture1D> Textures1D;
-    static std::map<std::string, std::shared_ptr<Texture2D>> Textures2D;
+    static ResourceRegistry<std::shared_ptr<Texture2D>> Textures2D;
     static std::map<std::string, Texture3D> Textures3D;
 
     // Shader management
     static Shader    LoadShader(const char *vShaderFile, const char *fShaderFile, std::string name);
     static Shader    LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-    static Shader    GetShader(std::string name);
-    static Shader*   ShaderP(std::string& name);
+    // Batched loading: queued programs are compiled together (or loaded
+    // from the binary cache) by LoadQueuedShaders
+    static void      QueueShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
+    static void      LoadQueuedShaders();
+    // Vertex-only program for transform feedback (see Shader::CompileFeedback);
+    // not cached, the binary would have to record the varyings too
+    static Shader   &LoadFeedbackShader(const char *vShaderFile, const std::vector<const char *> &varyings, std::string name);
+    static ShaderHandle FindShader(const std::string &name);
+    // An empty shader is registered for unknown names. The reference stays
+    // valid until the shader is removed or Clear() runs
+    static Shader   &GetShader(const std::string &name);
+    static Shader   &GetShader(ShaderHandle handle);
+    static Shader*   ShaderP(const std::string &name);
 
     // Texture management
     static Texture1D LoadTexture1D(const char *file, bool alpha, std::string name,
@@ -54,23 +72,57 @@ public:
     static Texture2D LoadTexture2D(const char *file, std::string name = "", bool alpha = false,
                                    GLint sWrap = GL_REPEAT, GLint tWrap = GL_REPEAT,
                                    GLint minFilter = GL_LINEAR, GLint magFilter = GL_LINEAR);
-    static Texture2D GetTexture2D(std::string name);
-    static Texture2D* GetTexture(std::string name);
+    // Like LoadTexture2D, but decodes on the TextureLoader workers and
+    // returns before the pixels are uploaded (status stays 0 until then)
+    static std::shared_ptr<Texture2D> LoadTexture2DAsync(const char *file, std::string name = "", bool alpha = false,
+                                                         GLint sWrap = GL_REPEAT, GLint tWrap = GL_REPEAT,
+                                                         GLint minFilter = GL_LINEAR, GLint magFilter = GL_LINEAR);
+    // Loads the texture if nothing is registered under name yet
+    static TextureHandle FindTexture(const std::string &name);
+    // Both wait for the texture if it's still being loaded
+    static Texture2D &GetTexture2D(const std::string &name);
+    static Texture2D &GetTexture2D(TextureHandle handle);
+    static Texture2D* GetTexture(const std::string &name);
+    // Loads file (or its cooked copy) into the texture's existing GL name;
+    // this is how evicted textures come back
+    static bool      UploadTexture2D(Texture2D &texture, const char *file, bool alpha = false);
     static std::shared_ptr<Texture2D> GetTexture2DByIndex(size_t index);
     static Texture3D LoadTexture3D(const char *file, bool alpha, std::string name,
                                    GLint sWrap = GL_REPEAT, GLint tWrap = GL_REPEAT, GLint rWrap = GL_REPEAT,
                                    GLint minFilter = GL_LINEAR, GLint magFilter = GL_LINEAR);
     static Texture3D GetTexture3D(std::string name);
 
+    // Atlas management: packs the given texture files into shared pages;
+    // the pages are registered as "atlas_page<N>" textures
+    static TextureAtlas Atlas;
+    static void BuildAtlas(const std::vector<std::string> &files, unsigned int pageSize = 512, unsigned int padding = 2);
+    static const AtlasRegion* GetAtlasRegion(const std::string &name);
+
+    // Asset pack: every loader reads through ReadAsset. With LooseFirst
+    // (development builds, LOOSE_ASSETS) a loose file under root wins over
+    // the pack entry of the same relative path, so edited files show up;
+    // otherwise an open pack is read first and loose files only fill in
+    // what it lacks
+    static AssetPack Pack;
+    static bool LooseFirst;
+    static bool OpenPack(const std::string &path);
+    static bool ReadAsset(const std::string &path, AssetData &out);
+    // stbi_load through ReadAsset, or level 0 of the cooked copy when only
+    // that exists; free the result with stbi_image_free
+    static unsigned char *DecodeImage(const char *file, int *width, int *height, int *channels, int desiredChannels = 0);
+
     // Resource cleanup
     static void Clear();
 
-    // File path handling
+    // File path handling; the returned paths are interned and stay valid
+    // until Clear()
     static const char* GetFullPath(const std::string& filename);
     static const char* GetPath(const std::string& filename);
     static const char* GetModelPath(const std::string& filename);
     static const char* GetShaderPath(const std::string& filename);
     static const char* GetTexturePath(const std::string& filename);
+    // queues every image in textures/ that isn't loaded yet; files already
+    // packed into the atlas are skipped, so build the atlas first
     static void LoadAllTexturesFromDirectory();
     static std::string getExecutablePath();
     static std::string getExecutableName();
@@ -79,7 +131,11 @@ public:
 private:
     ResourceManager() { }
 
+    static std::vector<std::pair<std::string, ShaderCache::Source>> queuedShaders;
+    static StringArena paths;
+
     static Shader    loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
+    static ShaderCache::Source readShaderFiles(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile);
     static Texture1D loadTexture1DFromFile(const char *file, bool alpha, GLint sWrap, GLint minFilter, GLint magFilter);
     static Texture2D loadTexture2DFromFile(const char *file, bool alpha = false,
                                            GLint sWrap = GL_REPEAT, GLint tWrap = GL_REPEAT,
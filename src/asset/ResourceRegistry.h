@@ -0,0 +1,163 @@
+#ifndef RESOURCE_REGISTRY_H
+#define RESOURCE_REGISTRY_H
+
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "util/StringArena.h"
+
+// 32-bit reference to a registry slot: the low 20 bits index the slot, the
+// high 12 bits hold the slot's generation when the handle was made. Removing
+// a resource bumps the generation, so old handles stop resolving instead of
+// pointing at whatever reuses the slot. 0 is never a valid handle.
+template <typename T>
+struct ResourceHandle
+{
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    uint32_t Value = 0;
+
+    uint32_t Index() const { return Value & INDEX_MASK; }
+    uint32_t Generation() const { return Value >> INDEX_BITS; }
+    bool IsValid() const { return Value != 0; }
+    bool operator==(ResourceHandle other) const { return Value == other.Value; }
+    bool operator!=(ResourceHandle other) const { return Value != other.Value; }
+
+    static ResourceHandle Make(uint32_t index, uint32_t generation)
+    {
+        return { (generation << INDEX_BITS) | (index & INDEX_MASK) };
+    }
+};
+
+// Named resources stored in a flat array. Names are interned once and
+// resolved to a handle with Find(); Get() is then an index and a generation
+// compare, with no string work. Replacing a resource under an existing name
+// keeps its handle, so resolved handles survive reloads. Slots live in a
+// deque, so registering more resources never moves the existing ones and
+// pointers returned by Get() stay valid until that resource is removed.
+template <typename T>
+class ResourceRegistry
+{
+public:
+    typedef ResourceHandle<T> Handle;
+
+    // The handle registered under name, or an invalid one
+    Handle Find(std::string_view name) const
+    {
+        auto it = this->names.find(name);
+        return it != this->names.end() ? it->second : Handle();
+    }
+
+    // Registers or replaces the resource under name
+    Handle Set(std::string_view name, T value)
+    {
+        auto it = this->names.find(name);
+        if (it != this->names.end()) {
+            this->slots[it->second.Index()].Value = std::move(value);
+            return it->second;
+        }
+
+        uint32_t index;
+        if (!this->freeSlots.empty()) {
+            index = this->freeSlots.back();
+            this->freeSlots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(this->slots.size());
+            this->slots.push_back(Slot());
+        }
+        Slot &slot = this->slots[index];
+        slot.Name = this->arena.Intern(name);
+        slot.Value = std::move(value);
+        slot.Live = true;
+        Handle handle = Handle::Make(index, slot.Generation);
+        this->names.emplace(std::string_view(slot.Name, name.size()), handle);
+        return handle;
+    }
+
+    // The resource, or nullptr if the handle is stale or invalid
+    T *Get(Handle handle)
+    {
+        uint32_t index = handle.Index();
+        if (index >= this->slots.size())
+            return nullptr;
+        Slot &slot = this->slots[index];
+        return slot.Live && slot.Generation == handle.Generation() ? &slot.Value : nullptr;
+    }
+    const T *Get(Handle handle) const
+    {
+        return const_cast<ResourceRegistry *>(this)->Get(handle);
+    }
+    T *Get(std::string_view name) { return this->Get(this->Find(name)); }
+
+    const char *Name(Handle handle) const
+    {
+        return this->Get(handle) ? this->slots[handle.Index()].Name : nullptr;
+    }
+
+    bool Remove(std::string_view name)
+    {
+        auto it = this->names.find(name);
+        if (it == this->names.end())
+            return false;
+        uint32_t index = it->second.Index();
+        this->names.erase(it);
+        this->release(index);
+        return true;
+    }
+
+    // Drops everything; every handle handed out so far goes stale
+    void Clear()
+    {
+        for (uint32_t i = 0; i < this->slots.size(); ++i)
+            if (this->slots[i].Live)
+                this->release(i);
+        this->names.clear();
+        this->arena.Clear();
+    }
+
+    // Calls f(name, value) for every live resource, in slot order
+    template <typename F>
+    void ForEach(F f)
+    {
+        for (Slot &slot : this->slots)
+            if (slot.Live)
+                f(slot.Name, slot.Value);
+    }
+
+    size_t Size() const { return this->names.size(); }
+
+private:
+    struct Slot
+    {
+        T           Value{};
+        const char *Name = nullptr;
+        uint32_t    Generation = 1;
+        bool        Live = false;
+    };
+
+    std::deque<Slot>                                  slots;
+    std::vector<uint32_t>                             freeSlots;
+    std::unordered_map<std::string_view, Handle>      names;
+    StringArena                                       arena;
+
+    void release(uint32_t index)
+    {
+        Slot &slot = this->slots[index];
+        slot.Value = T();
+        slot.Name = nullptr;
+        slot.Live = false;
+        // skip generation 0 so a handle can never be 0
+        slot.Generation = (slot.Generation + 1) & Handle::GENERATION_MASK;
+        if (slot.Generation == 0)
+            slot.Generation = 1;
+        this->freeSlots.push_back(index);
+    }
+};
+
+#endif
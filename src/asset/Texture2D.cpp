@@ -1,5 +1,7 @@
 #include "Texture2D.h"
 #include "util/Util.h"
+#include "render/GLState.h"
+#include "TextureResidency.h"
 #include <GLFW/glfw3.h>
 #include <stdexcept>
 
@@ -15,26 +17,48 @@ Texture2D::Texture2D()
     glCheckError(__FILE__, __LINE__);
 
     // Set texture parameters
-    glBindTexture(GL_TEXTURE_2D, ID);
+    GLState::BindTexture(GL_TEXTURE_2D, ID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, Wrap_S);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, Wrap_T);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, Filter_Min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, Filter_Max);
-    glBindTexture(GL_TEXTURE_2D, 0);  // Unbind texture
 }
 
 void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data) {
     Width = width;
     Height = height;
-    Bind();
+    // bound without Bind(): uploading isn't a use, and touching here would
+    // re-enter TextureResidency while it's reloading this texture
+    GLState::BindTexture(GL_TEXTURE_2D, ID);
 
     glTexImage2D(GL_TEXTURE_2D, 0, Internal_Format, width, height, 0, Image_Format, GL_UNSIGNED_BYTE, data);
     glCheckError(__FILE__, __LINE__);
+    // an evicted texture was limited to level 0; generate the whole chain again
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
     glGenerateMipmap(GL_TEXTURE_2D);
     glCheckError(__FILE__, __LINE__);
 }
 
-void Texture2D::Bind() const {
-    glBindTexture(GL_TEXTURE_2D, ID);
+void Texture2D::GenerateLevels(unsigned int width, unsigned int height, unsigned int levels, const unsigned char* data) {
+    Width = width;
+    Height = height;
+    GLState::BindTexture(GL_TEXTURE_2D, ID);
+
+    size_t channels = Image_Format == GL_RGBA ? 4 : 3;
+    size_t offset = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int level = 0; level < levels; ++level) {
+        glTexImage2D(GL_TEXTURE_2D, level, Internal_Format, width, height, 0, Image_Format, GL_UNSIGNED_BYTE, data + offset);
+        offset += width * height * channels;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
     glCheckError(__FILE__, __LINE__);
+}
+
+void Texture2D::Bind(unsigned int unit) const {
+    TextureResidency::Touch(ID);
+    GLState::BindTexture(GL_TEXTURE_2D, ID, unit);
 }
\ No newline at end of file
@@ -18,7 +18,10 @@ public:
 
     Texture2D();
     void Generate(unsigned int width, unsigned int height, unsigned char* data);
-    void Bind() const;
+    // Uploads a precomputed mip chain: the levels follow each other in
+    // data, level 0 first, with tightly packed rows
+    void GenerateLevels(unsigned int width, unsigned int height, unsigned int levels, const unsigned char* data);
+    void Bind(unsigned int unit = 0) const;
 };
 
 #endif
\ No newline at end of file
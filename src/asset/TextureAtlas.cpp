@@ -0,0 +1,112 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <stb/stb_image.h>
+#include "ResourceManager.h"
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <stb/stb_rect_pack.h>
+
+bool TextureAtlas::Add(const std::string &name, const char *file)
+{
+    int width, height, nrChannels;
+    // always expand to RGBA so every page has one format
+    unsigned char *data = ResourceManager::DecodeImage(file, &width, &height, &nrChannels, 4);
+    if (!data)
+    {
+        std::cerr << "Failed to load atlas image: " << file << std::endl;
+        return false;
+    }
+    Image image;
+    image.name = name;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    this->pending.push_back(std::move(image));
+    return true;
+}
+
+void TextureAtlas::Build(unsigned int pageSize, unsigned int padding)
+{
+    std::vector<stbrp_rect> rects;
+    for (size_t i = 0; i < this->pending.size(); ++i)
+    {
+        const Image &image = this->pending[i];
+        unsigned int w = image.width + 2 * padding, h = image.height + 2 * padding;
+        if (w > pageSize || h > pageSize)
+        {
+            std::cerr << "Atlas image " << image.name << " (" << image.width << "x" << image.height
+                      << ") doesn't fit a " << pageSize << " page" << std::endl;
+            continue;
+        }
+        stbrp_rect rect = {};
+        rect.id = static_cast<int>(i);
+        rect.w = static_cast<stbrp_coord>(w);
+        rect.h = static_cast<stbrp_coord>(h);
+        rects.push_back(rect);
+    }
+
+    std::vector<stbrp_node> nodes(pageSize);
+    std::vector<unsigned char> page;
+    while (!rects.empty())
+    {
+        stbrp_context context;
+        stbrp_init_target(&context, pageSize, pageSize, nodes.data(), static_cast<int>(nodes.size()));
+        stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()));
+
+        page.assign(static_cast<size_t>(pageSize) * pageSize * 4, 0);
+        auto texture = std::make_shared<Texture2D>();
+        for (const stbrp_rect &rect : rects)
+        {
+            if (!rect.was_packed)
+                continue;
+            const Image &image = this->pending[rect.id];
+            // copy the image, clamping into the padding so its edges are extruded
+            for (int y = 0; y < rect.h; ++y)
+            {
+                int sy = std::clamp(y - static_cast<int>(padding), 0, image.height - 1);
+                for (int x = 0; x < rect.w; ++x)
+                {
+                    int sx = std::clamp(x - static_cast<int>(padding), 0, image.width - 1);
+                    const unsigned char *src = &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * 4];
+                    unsigned char *dst = &page[(static_cast<size_t>(rect.y + y) * pageSize + rect.x + x) * 4];
+                    std::copy(src, src + 4, dst);
+                }
+            }
+            AtlasRegion region;
+            region.Page = texture;
+            region.TextureOffset = glm::vec2(rect.x + padding, rect.y + padding) / static_cast<float>(pageSize);
+            region.TextureSize = glm::vec2(image.width, image.height) / static_cast<float>(pageSize);
+            region.Width = image.width;
+            region.Height = image.height;
+            this->regions[image.name] = region;
+        }
+
+        texture->Internal_Format = GL_RGBA;
+        texture->Image_Format = GL_RGBA;
+        texture->Generate(pageSize, pageSize, page.data());
+        texture->status = 1;
+        this->pages.push_back(texture);
+
+        // whatever didn't fit goes onto the next page
+        rects.erase(std::remove_if(rects.begin(), rects.end(),
+                                   [](const stbrp_rect &rect) { return rect.was_packed != 0; }),
+                    rects.end());
+    }
+    this->pending.clear();
+}
+
+const AtlasRegion *TextureAtlas::Find(const std::string &name) const
+{
+    auto it = this->regions.find(name);
+    return it != this->regions.end() ? &it->second : nullptr;
+}
+
+void TextureAtlas::Clear()
+{
+    this->pending.clear();
+    this->regions.clear();
+    this->pages.clear();
+}
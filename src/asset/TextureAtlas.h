@@ -0,0 +1,54 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Texture2D.h"
+
+// Sub-rectangle of an atlas page, in the form DrawSprite's
+// textureOffset/textureSize take
+struct AtlasRegion
+{
+    std::shared_ptr<Texture2D> Page;
+    glm::vec2    TextureOffset;  // top-left of the image, in page UVs
+    glm::vec2    TextureSize;    // size of the image, in page UVs
+    unsigned int Width, Height;  // size of the image, in pixels
+};
+
+// Packs small images into a few large RGBA pages at load time so sprites
+// drawn from different images can share one texture binding. Images are
+// decoded by Add() and packed by Build() with stb_rect_pack's skyline
+// packer. Every image gets a border of padding pixels that repeats its
+// edge, so linear filtering never pulls in a neighbour.
+class TextureAtlas
+{
+public:
+    // queues an image for the next Build(); false if it can't be decoded
+    bool Add(const std::string &name, const char *file);
+    // packs everything added so far into pageSize x pageSize pages and
+    // uploads them; images larger than a page are skipped with an error
+    void Build(unsigned int pageSize = 512, unsigned int padding = 2);
+
+    const AtlasRegion *Find(const std::string &name) const;
+    const std::vector<std::shared_ptr<Texture2D>> &Pages() const { return pages; }
+    // forgets regions and pages; the GL textures are owned by whoever
+    // registered them (ResourceManager)
+    void Clear();
+
+private:
+    struct Image
+    {
+        std::string                name;
+        int                        width, height;
+        std::vector<unsigned char> pixels;  // RGBA8
+    };
+    std::vector<Image>                      pending;
+    std::map<std::string, AtlasRegion>      regions;
+    std::vector<std::shared_ptr<Texture2D>> pages;
+};
+
+#endif
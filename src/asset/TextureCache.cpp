@@ -0,0 +1,117 @@
+#include "TextureCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ResourceManager.h"
+#include "util/Util.h"
+
+bool TextureCache::Enabled = true;
+
+namespace fs = std::filesystem;
+
+// size and mtime of the source as stored in the header
+static bool sourceStamp(const std::string &source, uint64_t &size, int64_t &time)
+{
+    std::error_code error;
+    size = fs::file_size(source, error);
+    if (error)
+        return false;
+    time = static_cast<int64_t>(fs::last_write_time(source, error).time_since_epoch().count());
+    return !error;
+}
+
+static uint64_t sourceHash(const std::string &source)
+{
+    MappedFile file;
+    if (!file.Open(source))
+        return 0;
+    return hashBytes(file.Data(), file.Size());
+}
+
+std::string TextureCache::pathFor(const std::string &source)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hashBytes(source.data(), source.size())));
+    return ResourceManager::root + "cache/textures/" + name + ".tex";
+}
+
+// reads and validates one candidate; loose is false when the source only exists in the pack
+static bool openCooked(const std::string &path, bool loose, uint64_t size, int64_t time,
+                       const std::string &source, TextureCache::Cooked &out)
+{
+    AssetData data;
+    CookedTexture::Header header;
+    if (!ResourceManager::ReadAsset(path, data) || !CookedTexture::Parse(data.Data(), data.Size(), header))
+        return false;
+    if (loose) {
+        if (header.SourceSize != size)
+            return false;
+        // a touched but unchanged file (fresh checkout, copied assets) still hits
+        if (header.SourceTime != time && header.SourceHash != sourceHash(source))
+            return false;
+    }
+    out.Width = header.Width;
+    out.Height = header.Height;
+    out.Channels = header.Channels;
+    out.Levels = header.Levels;
+    out.PixelBytes = CookedTexture::ChainBytes(header.Width, header.Height, header.Channels, header.Levels);
+    out.Data = std::move(data);
+    out.Pixels = out.Data.Data() + sizeof(CookedTexture::Header);
+    return true;
+}
+
+bool TextureCache::Open(const std::string &source, Cooked &out)
+{
+    if (!Enabled)
+        return false;
+    uint64_t size = 0;
+    int64_t time = 0;
+    bool loose = sourceStamp(source, size, time);
+    if (openCooked(source + ".tex", loose, size, time, source, out))
+        return true;
+    return loose && openCooked(pathFor(source), true, size, time, source, out);
+}
+
+bool TextureCache::Store(const std::string &source, const unsigned char *pixels,
+                         unsigned int width, unsigned int height, unsigned int channels)
+{
+    // the loaders only know RGB and RGBA
+    if (!Enabled || (channels != 3 && channels != 4))
+        return false;
+    uint64_t size;
+    int64_t time;
+    if (!sourceStamp(source, size, time))
+        return false;
+    std::vector<unsigned char> cooked = CookedTexture::Cook(pixels, width, height, channels, size, time, sourceHash(source));
+
+    // write next to the final name and rename, so readers never map half a file
+    std::string path = pathFor(source);
+    std::string temp = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    std::error_code error;
+    fs::create_directories(fs::path(path).parent_path(), error);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        out.write(reinterpret_cast<const char *>(cooked.data()), static_cast<std::streamsize>(cooked.size()));
+        if (!out) {
+            out.close();
+            fs::remove(temp, error);
+            return false;
+        }
+    }
+    fs::rename(temp, path, error);
+    if (error) {
+        std::cerr << "Failed to write texture cache: " << path << std::endl;
+        fs::remove(temp, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "AssetPack.h"
+#include "CookedTexture.h"
+#include "Texture2D.h"
+
+// Cooked copies of decoded textures (see CookedTexture), so a warm start
+// maps a file and uploads it instead of inflating PNGs. Two places are
+// looked at, in order:
+//  - <source>.tex, shipped by the cooker as a loose file or in the pack;
+//    trusted as-is when the source itself only lives in the pack
+//  - <root>/cache/textures/<hash of the path>.tex, written on a miss
+// An entry checked against a loose source is used while the source's size
+// matches and either its mtime or its content hash does.
+class TextureCache
+{
+public:
+    // A cache hit; Pixels points into Data and stays valid as long as this
+    // object does
+    struct Cooked
+    {
+        AssetData            Data;
+        unsigned int         Width = 0, Height = 0, Channels = 0, Levels = 0;
+        const unsigned char *Pixels = nullptr;
+        size_t               PixelBytes = 0;
+    };
+
+    // turns the cache off; lookups miss and nothing is written
+    static bool Enabled;
+
+    // Both are safe to call from any thread
+    static bool Open(const std::string &source, Cooked &out);
+    static bool Store(const std::string &source, const unsigned char *pixels,
+                      unsigned int width, unsigned int height, unsigned int channels);
+
+private:
+    TextureCache() { }
+
+    static std::string pathFor(const std::string &source);
+};
+
+#endif
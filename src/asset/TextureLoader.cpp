@@ -0,0 +1,243 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <stb/stb_image.h>
+#include "util/Util.h"
+#include "render/GLState.h"
+#include "TextureCache.h"
+#include "ResourceManager.h"
+#include "TextureResidency.h"
+
+std::vector<std::thread>                            TextureLoader::workers;
+std::mutex                                          TextureLoader::mutex;
+std::condition_variable                             TextureLoader::jobAdded;
+std::condition_variable                             TextureLoader::jobDecoded;
+std::deque<std::shared_ptr<TextureLoader::Job>>     TextureLoader::queued;
+std::deque<std::shared_ptr<TextureLoader::Job>>     TextureLoader::decoded;
+size_t                                              TextureLoader::inFlight = 0;
+const Texture2D                                    *TextureLoader::uploading = nullptr;
+bool                                                TextureLoader::stopping = false;
+GLuint                                              TextureLoader::pbo = 0;
+size_t                                              TextureLoader::pboSize = 0;
+
+void TextureLoader::Init(unsigned int threads)
+{
+    if (!workers.empty())
+        return;
+    if (threads == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        threads = cores > 1 ? cores - 1 : 1;
+    }
+    stopping = false;
+    for (unsigned int i = 0; i < threads; ++i)
+        workers.emplace_back(&TextureLoader::work);
+}
+
+void TextureLoader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAdded.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+
+    for (auto &job : decoded)
+        stbi_image_free(job->pixels);
+    queued.clear();
+    decoded.clear();
+    inFlight = 0;
+    if (pbo != 0) {
+        glDeleteBuffers(1, &pbo);
+        pbo = 0;
+        pboSize = 0;
+    }
+}
+
+std::shared_ptr<Texture2D> TextureLoader::LoadAsync(const char *file, bool alpha, GLint sWrap, GLint tWrap, GLint minFilter, GLint magFilter)
+{
+    auto texture = std::make_shared<Texture2D>();
+    texture->status = 0;
+    texture->Wrap_S = sWrap;
+    texture->Wrap_T = tWrap;
+    texture->Filter_Min = minFilter;
+    texture->Filter_Max = magFilter;
+
+    Reload(texture, file, alpha);
+    return texture;
+}
+
+void TextureLoader::Reload(const std::shared_ptr<Texture2D> &texture, const std::string &file, bool alpha, bool urgent)
+{
+    texture->status = 0;
+    auto job = std::make_shared<Job>();
+    job->texture = texture;
+    job->file = file;
+    job->alpha = alpha;
+    if (workers.empty())
+        Init();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (urgent)
+            queued.push_front(job);
+        else
+            queued.push_back(job);
+        inFlight++;
+    }
+    jobAdded.notify_one();
+}
+
+unsigned int TextureLoader::Update(double budgetMs)
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned int uploaded = 0;
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (decoded.empty())
+                break;
+            job = decoded.front();
+            decoded.pop_front();
+        }
+        upload(*job);
+        uploaded++;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inFlight--;
+        }
+        std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - start;
+        if (spent.count() >= budgetMs)
+            break;
+    }
+    return uploaded;
+}
+
+void TextureLoader::Wait(const std::shared_ptr<Texture2D> &texture)
+{
+    // called from inside its own upload; that job is off the queues already
+    if (IsUploading(*texture))
+        return;
+    // uploads have to happen on this thread, so keep draining until ours is done
+    while (texture->status == 0) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobDecoded.wait(lock, [] { return !decoded.empty() || inFlight == 0; });
+            if (decoded.empty())
+                return;
+        }
+        Update(0.0);
+    }
+}
+
+void TextureLoader::Finish()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobDecoded.wait(lock, [] { return !decoded.empty() || inFlight == 0; });
+            if (decoded.empty())
+                return;
+        }
+        Update(0.0);
+    }
+}
+
+size_t TextureLoader::Pending()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return inFlight;
+}
+
+void TextureLoader::work()
+{
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAdded.wait(lock, [] { return stopping || !queued.empty(); });
+            if (stopping)
+                return;
+            job = queued.front();
+            queued.pop_front();
+        }
+        if (!TextureCache::Open(job->file, job->cooked)) {
+            job->pixels = ResourceManager::DecodeImage(job->file.c_str(), &job->width, &job->height, &job->channels, 0);
+            // cook it here, off the GL thread, so the next start skips the decode
+            if (job->pixels)
+                TextureCache::Store(job->file, job->pixels, job->width, job->height, job->channels);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back(job);
+        }
+        jobDecoded.notify_all();
+    }
+}
+
+void TextureLoader::upload(Job &job)
+{
+    Texture2D &texture = *job.texture;
+    bool cooked = job.cooked.Pixels != nullptr;
+    if (!cooked && !job.pixels) {
+        std::cerr << "Failed to load texture: " << job.file << std::endl;
+        texture.status = -1;
+        return;
+    }
+    if (cooked ? job.cooked.Channels == 4 : (job.alpha || job.channels > 3)) {
+        texture.Internal_Format = GL_RGBA;
+        texture.Image_Format = GL_RGBA;
+    } else {
+        texture.Internal_Format = GL_RGB;
+        texture.Image_Format = GL_RGB;
+    }
+    const unsigned char *pixels = cooked ? job.cooked.Pixels : job.pixels;
+    size_t bytes = cooked ? job.cooked.PixelBytes : static_cast<size_t>(job.width) * job.height * job.channels;
+
+    if (pbo == 0)
+        glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    // orphan the storage so the copy never waits on the previous upload
+    pboSize = std::max(pboSize, bytes);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, pboSize, nullptr, GL_STREAM_DRAW);
+    void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    const unsigned char *source = pixels;
+    if (mapped) {
+        std::memcpy(mapped, pixels, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        // with a PBO bound the data pointer is an offset into it
+        source = nullptr;
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // RGB rows aren't 4-byte aligned for every width
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    uploading = &texture;
+    // not Bind(): that would touch the texture, and TextureResidency would
+    // try to wait for the upload we're in the middle of
+    GLState::BindTexture(GL_TEXTURE_2D, texture.ID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texture.Wrap_S);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture.Wrap_T);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.Filter_Max);
+    if (cooked)
+        texture.GenerateLevels(job.cooked.Width, job.cooked.Height, job.cooked.Levels, source);
+    else
+        texture.Generate(job.width, job.height, const_cast<unsigned char *>(source));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    stbi_image_free(job.pixels);
+    job.pixels = nullptr;
+    job.cooked.Data = AssetData();
+    glCheckError(__FILE__, __LINE__);
+    texture.status = 1;
+    uploading = nullptr;
+    TextureResidency::Track(job.texture, job.file, job.alpha);
+}
@@ -0,0 +1,80 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Texture2D.h"
+#include "TextureCache.h"
+
+// Decodes images on a pool of worker threads and finishes them on the GL
+// thread. LoadAsync hands back the texture right away: its GL name is
+// valid from the start (so copies made before the upload still work) and
+// its status stays 0 until Update() has uploaded the pixels, after which
+// it's 1 (or -1 if decoding failed). Uploads go through a pixel buffer
+// object so glTexImage2D returns without waiting on the copy.
+class TextureLoader
+{
+public:
+    // starts the workers; 0 picks one per core, minus the GL thread
+    static void Init(unsigned int threads = 0);
+    // stops the workers and drops whatever hasn't been uploaded
+    static void Shutdown();
+
+    // queues a decode; must be called on the GL thread
+    static std::shared_ptr<Texture2D> LoadAsync(const char *file, bool alpha = false,
+                                                GLint sWrap = GL_REPEAT, GLint tWrap = GL_REPEAT,
+                                                GLint minFilter = GL_LINEAR, GLint magFilter = GL_LINEAR);
+
+    // reloads an existing texture into its own GL name (used for evicted
+    // textures); its status is 0 until the upload. Urgent reloads skip
+    // ahead of everything queued
+    static void Reload(const std::shared_ptr<Texture2D> &texture, const std::string &file, bool alpha, bool urgent = false);
+
+    // uploads finished decodes until budgetMs has been spent, at least one
+    // per call; returns the number uploaded
+    static unsigned int Update(double budgetMs = 2.0);
+    // blocks until this texture is uploaded
+    static void Wait(const std::shared_ptr<Texture2D> &texture);
+    // blocks until everything queued so far is uploaded
+    static void Finish();
+    // textures queued or decoded but not uploaded yet
+    static size_t Pending();
+    // whether texture's upload is running right now (GL thread only)
+    static bool IsUploading(const Texture2D &texture) { return uploading == &texture; }
+
+private:
+    TextureLoader() { }
+
+    struct Job
+    {
+        std::shared_ptr<Texture2D> texture;
+        std::string                file;
+        bool                       alpha;
+        // filled in by the worker: either a cache hit or decoded pixels
+        TextureCache::Cooked       cooked;
+        unsigned char             *pixels = nullptr;
+        int                        width = 0, height = 0, channels = 0;
+    };
+
+    static std::vector<std::thread>           workers;
+    static std::mutex                         mutex;
+    static std::condition_variable            jobAdded, jobDecoded;
+    static std::deque<std::shared_ptr<Job>>   queued, decoded;
+    static size_t                             inFlight;
+    static const Texture2D                   *uploading;
+    static bool                               stopping;
+    static GLuint                             pbo;
+    static size_t                             pboSize;
+
+    static void work();
+    static void upload(Job &job);
+};
+
+#endif
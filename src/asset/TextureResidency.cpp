@@ -0,0 +1,143 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+
+#include "ResourceManager.h"
+#include "TextureLoader.h"
+#include "util/Util.h"
+#include "render/GLState.h"
+
+size_t                          TextureResidency::Budget = 256u * 1024u * 1024u;
+unsigned int                    TextureResidency::IdleFrames = 300;
+std::vector<TextureResidency::Entry> TextureResidency::entries;
+uint64_t                        TextureResidency::frame = 0;
+size_t                          TextureResidency::residentBytes = 0;
+unsigned int                    TextureResidency::evictions = 0;
+unsigned int                    TextureResidency::reloads = 0;
+
+size_t TextureResidency::Bytes(unsigned int width, unsigned int height)
+{
+    // drivers pad RGB8 to four bytes per texel, so count RGBA for both
+    size_t bytes = 0;
+    while (true) {
+        bytes += static_cast<size_t>(width) * height * 4;
+        if (width <= 1 && height <= 1)
+            break;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes;
+}
+
+void TextureResidency::Track(const std::shared_ptr<Texture2D> &texture, const std::string &file, bool alpha)
+{
+    if (!texture || texture->status != 1)
+        return;
+    if (texture->ID >= entries.size())
+        entries.resize(texture->ID + 1);
+    Entry &entry = entries[texture->ID];
+    if (entry.Texture && entry.Resident)
+        residentBytes -= entry.Bytes;
+    entry.Texture = texture;
+    entry.File = file;
+    entry.Alpha = alpha;
+    entry.Resident = true;
+    entry.Loading = false;
+    entry.Bytes = Bytes(texture->Width, texture->Height);
+    entry.LastFrame = frame;
+    residentBytes += entry.Bytes;
+}
+
+void TextureResidency::Prefetch(GLuint id, bool urgent)
+{
+    if (id >= entries.size() || !entries[id].Texture)
+        return;
+    Entry &entry = entries[id];
+    entry.LastFrame = frame;
+    if (entry.Resident || entry.Loading || entry.File.empty())
+        return;
+    // the upload calls Track, which marks it resident again
+    entry.Loading = true;
+    TextureLoader::Reload(entry.Texture, entry.File, entry.Alpha, urgent);
+}
+
+void TextureResidency::Forget(GLuint id)
+{
+    if (id >= entries.size() || !entries[id].Texture)
+        return;
+    if (entries[id].Resident)
+        residentBytes -= entries[id].Bytes;
+    entries[id] = Entry();
+}
+
+void TextureResidency::Update()
+{
+    frame++;
+    if (residentBytes <= Budget)
+        return;
+
+    std::vector<Entry *> idle;
+    for (Entry &entry : entries) {
+        if (entry.Texture && entry.Resident && !entry.File.empty() && frame - entry.LastFrame > IdleFrames)
+            idle.push_back(&entry);
+    }
+    // oldest first
+    std::sort(idle.begin(), idle.end(), [](const Entry *a, const Entry *b) { return a->LastFrame < b->LastFrame; });
+    for (Entry *entry : idle) {
+        if (residentBytes <= Budget)
+            break;
+        evict(*entry);
+    }
+}
+
+void TextureResidency::Clear()
+{
+    entries.clear();
+    residentBytes = 0;
+}
+
+void TextureResidency::reload(Entry &entry)
+{
+    // the loader is uploading it right now and will Track it when done
+    if (TextureLoader::IsUploading(*entry.Texture))
+        return;
+    if (entry.Loading || entry.Texture->status == 0) {
+        // decoded (or nearly) in the background already; finish that instead
+        // of uploading a second copy
+        TextureLoader::Wait(entry.Texture);
+        entry.Loading = false;
+        if (entry.Resident)
+            return;
+        entry.Texture->status = 1;
+    }
+    entry.Resident = true;
+    if (!ResourceManager::UploadTexture2D(*entry.Texture, entry.File.c_str(), entry.Alpha)) {
+        // keep drawing the placeholder pixel rather than retrying every bind
+        entry.File.clear();
+        return;
+    }
+    entry.Bytes = Bytes(entry.Texture->Width, entry.Texture->Height);
+    residentBytes += entry.Bytes;
+    reloads++;
+}
+
+void TextureResidency::evict(Entry &entry)
+{
+    // a single transparent pixel lets the driver release the old storage
+    // while the name, and every copy of the Texture2D, stays valid
+    static const unsigned char pixel[4] = { 0, 0, 0, 0 };
+    Texture2D &texture = *entry.Texture;
+    GLState::BindTexture(GL_TEXTURE_2D, texture.ID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, texture.Internal_Format, 1, 1, 0, texture.Image_Format, GL_UNSIGNED_BYTE, pixel);
+    GLint level = 1;
+    for (unsigned int size = std::max(texture.Width, texture.Height); size > 1; size /= 2)
+        glTexImage2D(GL_TEXTURE_2D, level++, texture.Internal_Format, 0, 0, 0, texture.Image_Format, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // the emptied levels would leave it mipmap-incomplete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glCheckError(__FILE__, __LINE__);
+    entry.Resident = false;
+    residentBytes -= entry.Bytes;
+    evictions++;
+}
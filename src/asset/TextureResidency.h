@@ -0,0 +1,82 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Texture2D.h"
+
+// Keeps the estimated GPU memory of loaded 2D textures under a budget.
+// Every bind touches the texture; once the total goes over Budget, the
+// least recently used textures that weren't touched for IdleFrames frames
+// are evicted by re-specifying their level 0 as a single pixel. The GL name
+// stays the same, so the Texture2D copies held by game objects stay valid,
+// and the next touch reloads the image (from its cooked copy when there is
+// one) before it's drawn.
+class TextureResidency
+{
+public:
+    // bytes of texture memory we try to stay under
+    static size_t       Budget;
+    // frames a texture must go unused before it may be evicted
+    static unsigned int IdleFrames;
+
+    // starts tracking a loaded texture; textures without a file (atlas
+    // pages, render targets) count against the budget but are never evicted
+    static void Track(const std::shared_ptr<Texture2D> &texture, const std::string &file, bool alpha);
+    // marks the texture as used this frame, reloading it if it was evicted;
+    // a reload already running in the background is waited for instead
+    static void Touch(GLuint id)
+    {
+        if (id < entries.size() && entries[id].Texture)
+            touch(entries[id]);
+    }
+    // marks the texture as used and, if it was evicted, starts reloading it
+    // on the TextureLoader workers so a later Touch finds it resident
+    static void Prefetch(GLuint id, bool urgent = false);
+    static void Forget(GLuint id);
+    // advances the frame counter and evicts until we're under budget
+    static void Update();
+    static void Clear();
+
+    // estimated size of a texture with a full mip chain
+    static size_t Bytes(unsigned int width, unsigned int height);
+
+    static size_t       ResidentBytes() { return residentBytes; }
+    static unsigned int Evictions() { return evictions; }
+    static unsigned int Reloads() { return reloads; }
+
+private:
+    TextureResidency() { }
+
+    struct Entry
+    {
+        std::shared_ptr<Texture2D> Texture;
+        std::string                File;
+        bool                       Alpha = false;
+        bool                       Resident = false;
+        bool                       Loading = false;
+        size_t                     Bytes = 0;
+        uint64_t                   LastFrame = 0;
+    };
+
+    // indexed by GL texture name, so a touch is a bounds check and a store
+    static std::vector<Entry> entries;
+    static uint64_t           frame;
+    static size_t             residentBytes;
+    static unsigned int       evictions, reloads;
+
+    static void touch(Entry &entry)
+    {
+        entry.LastFrame = frame;
+        if (!entry.Resident)
+            reload(entry);
+    }
+    static void reload(Entry &entry);
+    static void evict(Entry &entry);
+};
+
+#endif
@@ -1,6 +1,11 @@
 #include "TilemapManager.h"
 #include <iostream>
 
+#include "render/GLState.h"
+#include "util/Util.h"
+#include "game/Camera.h"
+#include <algorithm>
+
 TilemapManager::TilemapManager(const std::string& texturePath, unsigned int tilesAcross, unsigned int tilesDown)
     : texturePath(texturePath), tilesAcross(tilesAcross), tilesDown(tilesDown) {
     ResourceManager::LoadTexture2D(texturePath.c_str(), "tilemap");
@@ -24,11 +29,67 @@ TilemapManager::TilemapManager(const std::string& texturePath, const std::string
         ResourceManager::GetTexture2D(bgTexturePath)
     ); 
 }
+TilemapManager::~TilemapManager() {
+    if (meshVAO != 0) {
+        GLState::ForgetVertexArray(meshVAO);
+        glDeleteVertexArrays(1, &meshVAO);
+        glDeleteBuffers(1, &meshVBO);
+    }
+    if (indexTexture != 0) {
+        GLState::ForgetTexture(indexTexture);
+        glDeleteTextures(1, &indexTexture);
+    }
+}
 void TilemapManager::LoadTilemap(const std::vector<std::vector<unsigned int>>& tileData, 
                                 [[maybe_unused]] unsigned int levelWidth, 
                                 [[maybe_unused]] unsigned int levelHeight) {
     tiles.clear();
 
+    // Rows may be ragged; the index grid is padded with empty tiles
+    gridHeight = static_cast<unsigned int>(tileData.size());
+    gridWidth = 0;
+    for (const auto& row : tileData)
+        gridWidth = std::max(gridWidth, static_cast<unsigned int>(row.size()));
+    tileGrid.assign(gridWidth * gridHeight, 0);
+    gridToTile.assign(gridWidth * gridHeight, -1);
+
+    for (unsigned int row = 0; row < tileData.size(); ++row) {
+        for (unsigned int col = 0; col < tileData[row].size(); ++col) {
+            unsigned int tileIndex = tileData[row][col];
+
+            tileGrid[row * gridWidth + col] = static_cast<unsigned short>(tileIndex);
+            gridToTile[row * gridWidth + col] = static_cast<int>(tiles.size());
+            tiles.push_back(makeTile(row, col, tileIndex));
+        }
+    }
+    bakeMesh();
+    if (indexTexture != 0)
+        uploadIndexTexture();
+}
+void TilemapManager::LoadTilemap(const LevelFile& level) {
+    tiles.clear();
+
+    // The binary grid is already padded, so it becomes tileGrid directly
+    gridWidth = level.Width();
+    gridHeight = level.Height();
+    const uint16_t* ids = level.Layer(0);
+    tileGrid.assign(ids, ids + static_cast<size_t>(gridWidth) * gridHeight);
+    gridToTile.resize(tileGrid.size());
+    tiles.reserve(tileGrid.size());
+
+    for (unsigned int row = 0; row < gridHeight; ++row) {
+        for (unsigned int col = 0; col < gridWidth; ++col) {
+            unsigned int cell = row * gridWidth + col;
+            gridToTile[cell] = static_cast<int>(tiles.size());
+            tiles.push_back(makeTile(row, col, tileGrid[cell]));
+            tiles.back().IsSolid = level.IsSolid(row, col);
+        }
+    }
+    bakeMesh();
+    if (indexTexture != 0)
+        uploadIndexTexture();
+}
+TilemapManager::Tile TilemapManager::makeTile(unsigned int row, unsigned int col, unsigned int tileIndex) const {
     // Calculate individual tile dimensions in world space
     float tileWorldWidth = static_cast<float>(texture->Width);
     float tileWorldHeight = static_cast<float>(texture->Height);
@@ -37,36 +98,178 @@ void TilemapManager::LoadTilemap(const std::vector<std::vector<unsigned int>>& t
     float tileUVWidth = 1.0f / static_cast<float>(tilesAcross);
     float tileUVHeight = 1.0f / static_cast<float>(tilesDown);
 
-    for (unsigned int row = 0; row < tileData.size(); ++row) {
-        for (unsigned int col = 0; col < tileData[row].size(); ++col) {
-            unsigned int tileIndex = tileData[row][col];
+    // Calculate texture coordinates (UV offset)
+    unsigned int texCol = (tileIndex - 1) % tilesAcross;
+    unsigned int texRow = (tileIndex - 1) / tilesAcross;
 
-            //if (tileIndex == 0) continue; // Skip empty tiles
+    Tile tile;
+    tile.Position = glm::vec2(col * tileWorldWidth, row * tileWorldHeight);
+    tile.Size = glm::vec2(tileWorldWidth, tileWorldHeight);
+    tile.TileID = tileIndex;
+    if(tileIndex != 0){
+        tile.TextureOffset = glm::vec2(texCol * tileUVWidth, texRow * tileUVHeight);
+        tile.TextureSize = glm::vec2(tileUVWidth, tileUVHeight);
+    } else {
+        tile.TextureOffset = glm::vec2(0.0f,0.0f);
+        tile.TextureSize = glm::vec2(0.0f,0.0f);
+    }
+    tile.IsSolid = LevelFile::DefaultSolid(tileIndex);
+    return tile;
+}
+void TilemapManager::SetTile(unsigned int row, unsigned int col, unsigned int tileId) {
+    if (row >= gridHeight || col >= gridWidth) {
+        std::cerr << "SetTile: (" << row << ", " << col << ") is outside the map" << std::endl;
+        return;
+    }
+    unsigned int cell = row * gridWidth + col;
+    tileGrid[cell] = static_cast<unsigned short>(tileId);
+    if (gridToTile[cell] < 0) {
+        gridToTile[cell] = static_cast<int>(tiles.size());
+        tiles.push_back(makeTile(row, col, tileId));
+    } else {
+        tiles[gridToTile[cell]] = makeTile(row, col, tileId);
+    }
 
-            // Calculate texture coordinates (UV offset)
-            unsigned int texCol = (tileIndex - 1) % tilesAcross;
-            unsigned int texRow = (tileIndex - 1) / tilesAcross;
+    // One texel for the index texture; the baked mesh is rebuilt before its next draw
+    if (indexTexture != 0) {
+        unsigned short texel = tileGrid[cell];
+        GLState::BindTexture(GL_TEXTURE_2D, indexTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, col, row, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_SHORT, &texel);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glCheckError(__FILE__, __LINE__);
+    }
+    meshDirty = true;
+}
+bool TilemapManager::TileRange(glm::vec2 position, glm::vec2 size,
+                               unsigned int& rowBegin, unsigned int& rowEnd,
+                               unsigned int& colBegin, unsigned int& colEnd) const {
+    // Same tile size as makeTile; tiles start at the origin
+    glm::vec2 tileSize(static_cast<float>(texture->Width), static_cast<float>(texture->Height));
+    if (gridWidth == 0 || gridHeight == 0 || tileSize.x <= 0.0f || tileSize.y <= 0.0f)
+        return false;
 
-            glm::vec2 tilePosition(col * tileWorldWidth, row * tileWorldHeight);
-            glm::vec2 tileSize(tileWorldWidth, tileWorldHeight);
-            glm::vec2 textureOffset(texCol * tileUVWidth, texRow * tileUVHeight);
-            glm::vec2 textureSize(tileUVWidth, tileUVHeight);
+    // A tile touching the rectangle's edge counts, like Collider::CheckCollision
+    glm::vec2 first = glm::ceil(position / tileSize) - 1.0f;
+    glm::vec2 last = glm::floor((position + size) / tileSize);
+    glm::vec2 limit(static_cast<float>(gridWidth - 1), static_cast<float>(gridHeight - 1));
+    if (!(last.x >= 0.0f && last.y >= 0.0f && first.x <= limit.x && first.y <= limit.y))
+        return false;
 
-            Tile tile;
-            tile.Position = tilePosition;
-            tile.Size = tileSize;
-            if(tileIndex != 0){
-                tile.TileID = tileIndex; 
-                tile.TextureOffset = textureOffset;
-                tile.TextureSize = textureSize;
-            } else {
-                tile.TextureSize = glm::vec2(0.0f,0.0f);
-            }
-            tile.IsSolid = (tileIndex != 40); // Mark solid tiles (customize as needed)
+    first = glm::max(first, glm::vec2(0.0f));
+    last = glm::min(last, limit);
+    colBegin = static_cast<unsigned int>(first.x);
+    colEnd = static_cast<unsigned int>(last.x) + 1;
+    rowBegin = static_cast<unsigned int>(first.y);
+    rowEnd = static_cast<unsigned int>(last.y) + 1;
+    return true;
+}
+bool TilemapManager::IsSolid(glm::vec2 position, glm::vec2 size) const {
+    bool solid = false;
+    ForEachSolidTile(position, size, [&](const Tile&) { solid = true; });
+    return solid;
+}
+void TilemapManager::EnableIndexTexture(const Shader& shader) {
+    indexShader = shader;
+    indexRectMinUniform = shader.GetUniform<glm::vec2>("rectMin");
+    indexRectSizeUniform = shader.GetUniform<glm::vec2>("rectSize");
+    indexTileSizeUniform = shader.GetUniform<glm::vec2>("tileSize");
+    indexAtlasTilesUniform = shader.GetUniform<glm::vec2>("atlasTiles");
+    if (indexTexture == 0) {
+        glGenTextures(1, &indexTexture);
+        GLState::BindTexture(GL_TEXTURE_2D, indexTexture);
+        // integer textures can't be filtered
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        uploadIndexTexture();
+    }
+    mode = RenderMode::IndexTexture;
+}
+void TilemapManager::uploadIndexTexture() {
+    GLState::BindTexture(GL_TEXTURE_2D, indexTexture);
+    // rows of 16-bit texels aren't 4-byte aligned when the width is odd
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16UI, gridWidth, gridHeight, 0,
+                 GL_RED_INTEGER, GL_UNSIGNED_SHORT, tileGrid.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glCheckError(__FILE__, __LINE__);
+}
+void TilemapManager::drawIndexTexture(SpriteRenderer& renderer, glm::vec2 viewMin, glm::vec2 viewMax) {
+    if (gridWidth == 0 || gridHeight == 0) return;
+    glm::vec2 tileSize(static_cast<float>(texture->Width), static_cast<float>(texture->Height));
+    // cover only the part of the map that is on screen
+    glm::vec2 rectMin = glm::max(viewMin, glm::vec2(0.0f));
+    glm::vec2 rectMax = glm::min(viewMax, tileSize * glm::vec2(gridWidth, gridHeight));
+    if (rectMin.x >= rectMax.x || rectMin.y >= rectMax.y) return;
 
-            tiles.push_back(tile);
+    renderer.Flush();
+    indexShader.Use();
+    indexShader.Set(indexRectMinUniform, rectMin);
+    indexShader.Set(indexRectSizeUniform, rectMax - rectMin);
+    indexShader.Set(indexTileSizeUniform, tileSize);
+    indexShader.Set(indexAtlasTilesUniform, glm::vec2(tilesAcross, tilesDown));
+    texture->Bind(0);
+    GLState::BindTexture(GL_TEXTURE_2D, indexTexture, 1);
+    renderer.DrawQuad();
+    visibleChunks = 0;
+}
+void TilemapManager::bakeMesh() {
+    // Bucket the non-empty tiles by chunk; tiles sit on a grid of their own size
+    auto chunkOf = [](const Tile& tile) {
+        return glm::uvec2(static_cast<unsigned int>(tile.Position.x / tile.Size.x + 0.5f) / CHUNK_SIZE,
+                          static_cast<unsigned int>(tile.Position.y / tile.Size.y + 0.5f) / CHUNK_SIZE);
+    };
+    unsigned int chunkCols = 0;
+    for (const Tile& tile : tiles)
+        chunkCols = std::max(chunkCols, chunkOf(tile).x + 1);
+
+    std::vector<std::pair<unsigned int, const Tile*>> sorted;
+    sorted.reserve(tiles.size());
+    for (const Tile& tile : tiles) {
+        if (tile.TileID == 0) continue; // Skip empty tiles
+        glm::uvec2 chunk = chunkOf(tile);
+        sorted.push_back({ chunk.y * chunkCols + chunk.x, &tile });
+    }
+    // row-major chunk order keeps neighbouring chunks contiguous in the buffer
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<SpriteVertex> vertices;
+    vertices.reserve(sorted.size() * 6);
+    chunks.clear();
+    unsigned int current = ~0u;
+    for (const auto& entry : sorted) {
+        const Tile& tile = *entry.second;
+        if (entry.first != current) {
+            current = entry.first;
+            chunks.push_back({ tile.Position, tile.Position + tile.Size, static_cast<int>(vertices.size()), 0 });
         }
+        Chunk& chunk = chunks.back();
+        chunk.Min = glm::min(chunk.Min, tile.Position);
+        chunk.Max = glm::max(chunk.Max, tile.Position + tile.Size);
+        chunk.Count += 6;
+        SpriteRenderer::AppendQuad(vertices, tile.Position, tile.Size, 0.0f, glm::vec3(1.0f),
+                                   tile.TextureOffset, tile.TextureSize);
     }
+    drawFirsts.reserve(chunks.size());
+    drawCounts.reserve(chunks.size());
+
+    if (meshVAO == 0) {
+        glGenVertexArrays(1, &meshVAO);
+        glGenBuffers(1, &meshVBO);
+        GLState::BindVertexArray(meshVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        SpriteRenderer::EnableVertexLayout();
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    }
+    // the map doesn't change while it's on screen, so upload it once
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SpriteVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glCheckError(__FILE__, __LINE__);
+    meshVertexCount = static_cast<int>(vertices.size());
 }
 void TilemapManager::LoadTilemap(glm::vec2 dim) {
     tiles.clear();
@@ -105,7 +308,41 @@ void TilemapManager::LoadTilemap(glm::vec2 dim) {
 }
 
 void TilemapManager::Draw(SpriteRenderer& renderer) {
+    glm::vec2 viewMin, viewMax;
+    Camera::Instance->GetVisibleRect(viewMin, viewMax);
+    auto visible = [&](glm::vec2 min, glm::vec2 max) {
+        return min.x < viewMax.x && max.x > viewMin.x && min.y < viewMax.y && max.y > viewMin.y;
+    };
+
+    if (mode == RenderMode::IndexTexture && indexTexture != 0) {
+        drawIndexTexture(renderer, viewMin, viewMax);
+        return;
+    }
+    if (meshDirty) {
+        meshDirty = false;
+        bakeMesh();
+    }
+    if (meshVAO != 0 && renderer.CanDrawMesh()) {
+        drawFirsts.clear();
+        drawCounts.clear();
+        visibleChunks = 0;
+        for (const Chunk& chunk : chunks) {
+            if (!visible(chunk.Min, chunk.Max)) continue;
+            visibleChunks++;
+            // merge with the previous range when the chunks are adjacent in the buffer
+            if (!drawFirsts.empty() && drawFirsts.back() + drawCounts.back() == chunk.First)
+                drawCounts.back() += chunk.Count;
+            else {
+                drawFirsts.push_back(chunk.First);
+                drawCounts.push_back(chunk.Count);
+            }
+        }
+        renderer.DrawMesh(*texture, meshVAO, drawFirsts.data(), drawCounts.data(), static_cast<int>(drawFirsts.size()));
+        return;
+    }
     for (const Tile& tile : tiles) {
+        if (tile.TileID == 0) continue; // Skip empty tiles
+        if (!visible(tile.Position, tile.Position + tile.Size)) continue;
         renderer.DrawSprite(
             *texture,                  // Texture to use
             tile.Position,             // Position in world space
@@ -117,9 +354,38 @@ void TilemapManager::Draw(SpriteRenderer& renderer) {
         );
     }
 }
+void TilemapManager::SetBackgroundShader(const Shader& shader) {
+    bgShader = shader;
+    bgRectMinUniform = shader.GetUniform<glm::vec2>("rectMin");
+    bgRectSizeUniform = shader.GetUniform<glm::vec2>("rectSize");
+    bgScrollUniform = shader.GetUniform<glm::vec2>("scroll");
+    bgParallaxUniform = shader.GetUniform<float>("parallax");
+    bgTextureSizeUniform = shader.GetUniform<glm::vec2>("textureSize");
+    bgCameraPosUniform = shader.GetUniform<glm::vec2>("cameraPos");
+    hasBgShader = true;
+}
 void TilemapManager::DrawBackground(SpriteRenderer& renderer, int width, int height) {
     glm::vec2 size = glm::vec2(bgTexture->Width, bgTexture->Height); // Tile size
 
+    if (hasBgShader) {
+        // One quad over the view; GL_REPEAT does the tiling
+        glm::vec2 viewMin, viewMax;
+        Camera::Instance->GetVisibleRect(viewMin, viewMax);
+
+        renderer.Flush();
+        bgShader.Use();
+        bgShader.Set(bgRectMinUniform, viewMin);
+        bgShader.Set(bgRectSizeUniform, viewMax - viewMin);
+        // the tiled version started its first copy at (-width / 2, -height / 4)
+        bgShader.Set(bgScrollUniform, BackgroundScroll + glm::vec2(width / 2.0f, height / 4.0f));
+        bgShader.Set(bgParallaxUniform, BackgroundParallax);
+        bgShader.Set(bgTextureSizeUniform, size);
+        bgShader.Set(bgCameraPosUniform, viewMin);
+        bgTexture->Bind();
+        renderer.DrawQuad();
+        return;
+    }
+
     for (int i = 0; i < width / size.x; i++) {
         for (int j = 0; j < height / size.y; j++) {
             renderer.DrawSprite(
@@ -132,6 +398,20 @@ void TilemapManager::DrawBackground(SpriteRenderer& renderer, int width, int hei
         }
     }
 }
+void TilemapManager::SubmitPlayer(RenderQueue& queue, unsigned int layer, float depth, glm::vec2 pos, int tile) {
+    if (tile < 0 || static_cast<size_t>(tile) >= tiles.size()) {
+        return;
+    }
+
+    if (!texture || texture->ID == 0) {
+        std::cerr << "Player texture not loaded properly!" << std::endl;
+        return;
+    }
+
+    const Tile& tileData = tiles[tile];
+    queue.SubmitSprite(layer, depth, *texture, pos, tileData.Size, 0.0f, glm::vec3(1.0f),
+                       tileData.TextureOffset, tileData.TextureSize);
+}
 void TilemapManager::DrawPlayer(SpriteRenderer& renderer, glm::vec2 pos, 
                               [[maybe_unused]] glm::vec2 size, int tile) {
     if (tile < 0 || static_cast<size_t>(tile) >= tiles.size()) {
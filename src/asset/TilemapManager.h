@@ -6,7 +6,9 @@
 #include <string>
 #include <memory>
 #include "ResourceManager.h"
+#include "LevelFile.h"
 #include "render/SpriteRenderer.h"
+#include "render/RenderQueue.h"
 #include "game/GameObject.h"
 
 /**
@@ -28,6 +30,26 @@ public:
     };
     std::vector<Tile> tiles;            ///< Vector storing tile data.
 
+    static constexpr unsigned int CHUNK_SIZE = 16; ///< Chunk edge length, in tiles.
+
+    /**
+     * @brief A CHUNK_SIZE x CHUNK_SIZE block of the map, culled as a unit.
+     */
+    struct Chunk {
+        glm::vec2 Min, Max;       ///< World-space bounds of the chunk's non-empty tiles.
+        int First;                ///< First vertex of the chunk in the baked mesh.
+        int Count;                ///< Number of vertices of the chunk.
+    };
+    std::vector<Chunk> chunks;          ///< Non-empty chunks, in mesh order.
+
+    /**
+     * @brief How Draw renders the map.
+     */
+    enum class RenderMode {
+        Mesh,         ///< Baked chunk geometry, culled per chunk.
+        IndexTexture  ///< One quad; the fragment shader looks tile IDs up in an R16UI texture.
+    };
+
     /**
      * @brief Constructs the TilemapManager with a given texture path and grid size.
      * @param texturePath Path to the texture atlas.
@@ -38,27 +60,155 @@ public:
     TilemapManager(const std::string& texturePath, const std::string& bgTexturePath, unsigned int tilesAcross, unsigned int tilesDown);
     TilemapManager(Texture2D& tex, unsigned int tilesAcross, unsigned int tilesDown);
     /**
-     * @brief Loads a tilemap configuration from tile data.
+     * @brief Releases the baked tile mesh.
+     */
+    ~TilemapManager();
+    TilemapManager(const TilemapManager&) = delete;
+    TilemapManager& operator=(const TilemapManager&) = delete;
+    /**
+     * @brief Loads a tilemap configuration from tile data and bakes the
+     * non-empty tiles into a static vertex buffer.
      * @param tileData 2D vector containing tile indices.
      * @param levelWidth Width of the tilemap in world units.
      * @param levelHeight Height of the tilemap in world units.
      */
     void LoadTilemap(const std::vector<std::vector<unsigned int>>& tileData, unsigned int levelWidth, unsigned int levelHeight);
+    /**
+     * @brief Loads layer 0 of a binary level; the tile IDs are copied from
+     * the mapping as-is and solidity comes from the level's bitset.
+     * @param level An open LevelFile.
+     */
+    void LoadTilemap(const LevelFile& level);
     void LoadTilemap(glm::vec2 dim);
 
     /**
-     * @brief Draws the tilemap using the specified renderer.
+     * @brief Draws the chunks of the tilemap that intersect the camera's
+     * visible rectangle, as a single multi-draw of the baked mesh when the
+     * renderer supports it.
      * @param renderer SpriteRenderer used for drawing.
      */
     void Draw(SpriteRenderer& renderer);
     void DrawPlayer(SpriteRenderer& renderer, glm::vec2 pos, glm::vec2 size, int tile);
+    /**
+     * @brief Queues the same sprite DrawPlayer would draw.
+     * @param queue Render queue of the frame.
+     * @param layer Queue layer.
+     * @param depth Sort depth within the layer.
+     * @param pos Position in world space.
+     * @param tile Index of the tile to draw.
+     */
+    void SubmitPlayer(RenderQueue& queue, unsigned int layer, float depth, glm::vec2 pos, int tile);
     void DrawBackground(SpriteRenderer& renderer, int width, int height);
 
+    /**
+     * @brief Makes DrawBackground cover the view with a single repeating quad
+     * instead of one sprite per copy of the texture.
+     * @param shader Background shader (shaders/background).
+     */
+    void SetBackgroundShader(const Shader& shader);
+    glm::vec2 BackgroundScroll = glm::vec2(0.0f); ///< Background pattern offset in world units.
+    float BackgroundParallax = 1.0f;              ///< 1 scrolls with the world, 0 stays fixed on screen.
+
+    /**
+     * @brief Number of chunks drawn by the last Draw call.
+     */
+    unsigned int VisibleChunks() const { return visibleChunks; }
+
+    /**
+     * @brief Uploads the tile IDs into an integer texture and switches Draw to
+     * the single-quad index texture renderer.
+     * @param shader Tilemap shader (shaders/tilemap).
+     */
+    void EnableIndexTexture(const Shader& shader);
+    void SetRenderMode(RenderMode renderMode) { mode = renderMode; }
+    RenderMode GetRenderMode() const { return mode; }
+
+    /**
+     * @brief Changes a single tile. Updates one texel of the index texture and
+     * rebuilds the baked mesh lazily before its next draw.
+     * @param row Tile row in the level.
+     * @param col Tile column in the level.
+     * @param tileId New tile index (0 for empty).
+     */
+    void SetTile(unsigned int row, unsigned int col, unsigned int tileId);
+
+    /**
+     * @brief Clamps a world-space rectangle to the rows and columns of the
+     * grid it touches, edges included.
+     * @param position Top-left corner of the rectangle.
+     * @param size Size of the rectangle.
+     * @param rowBegin, rowEnd, colBegin, colEnd Half-open cell range.
+     * @return False if the rectangle misses the map.
+     */
+    bool TileRange(glm::vec2 position, glm::vec2 size,
+                   unsigned int& rowBegin, unsigned int& rowEnd,
+                   unsigned int& colBegin, unsigned int& colEnd) const;
+
+    /**
+     * @brief Calls f(tile) for every solid tile touching the rectangle, in
+     * row-major order. Only the cells under the rectangle are visited, so the
+     * cost doesn't depend on the size of the map.
+     * @param position Top-left corner of the rectangle.
+     * @param size Size of the rectangle.
+     * @param f Callable taking a const Tile&.
+     */
+    template <typename F>
+    void ForEachSolidTile(glm::vec2 position, glm::vec2 size, F f) const {
+        unsigned int rowBegin, rowEnd, colBegin, colEnd;
+        if (!TileRange(position, size, rowBegin, rowEnd, colBegin, colEnd))
+            return;
+        for (unsigned int row = rowBegin; row < rowEnd; ++row) {
+            for (unsigned int col = colBegin; col < colEnd; ++col) {
+                int index = gridToTile[row * gridWidth + col];
+                if (index >= 0 && tiles[index].IsSolid)
+                    f(tiles[index]);
+            }
+        }
+    }
+
+    /**
+     * @brief Whether any solid tile touches the rectangle.
+     * @param position Top-left corner of the rectangle.
+     * @param size Size of the rectangle.
+     */
+    bool IsSolid(glm::vec2 position, glm::vec2 size) const;
+
 protected:
     std::string texturePath;            ///< Path to the texture atlas.
     unsigned int tilesAcross, tilesDown; ///< Number of tiles across and down the atlas.
     std::shared_ptr<Texture2D> texture; ///< Shared pointer to the texture resource.
     std::shared_ptr<Texture2D> bgTexture;
+    Shader bgShader;
+    bool hasBgShader = false;
+    Uniform<glm::vec2> bgRectMinUniform, bgRectSizeUniform, bgScrollUniform, bgTextureSizeUniform, bgCameraPosUniform;
+    Uniform<float> bgParallaxUniform;
+
+    unsigned int meshVAO = 0, meshVBO = 0; ///< Baked geometry of the non-empty tiles.
+    int meshVertexCount = 0;               ///< Number of vertices in the baked mesh.
+    std::vector<int> drawFirsts, drawCounts; ///< Ranges gathered by Draw, reused every frame.
+    unsigned int visibleChunks = 0;
+    bool meshDirty = false;                ///< Set by SetTile, cleared by the next bake.
+
+    std::vector<unsigned short> tileGrid;  ///< Tile IDs, row-major, padded to gridWidth.
+    std::vector<int> gridToTile;           ///< Index into tiles for every grid cell, -1 for padding.
+    unsigned int gridWidth = 0, gridHeight = 0;
+    RenderMode mode = RenderMode::Mesh;
+    unsigned int indexTexture = 0;         ///< GL_R16UI copy of tileGrid.
+    Shader indexShader;
+    Uniform<glm::vec2> indexRectMinUniform, indexRectSizeUniform, indexTileSizeUniform, indexAtlasTilesUniform;
+
+    /**
+     * @brief Builds the tile at a grid cell.
+     */
+    Tile makeTile(unsigned int row, unsigned int col, unsigned int tileIndex) const;
+    void uploadIndexTexture();
+    void drawIndexTexture(SpriteRenderer& renderer, glm::vec2 viewMin, glm::vec2 viewMax);
+
+    /**
+     * @brief Uploads the non-empty tiles as world-space quads into meshVBO,
+     * grouped by chunk, and fills in the chunk list.
+     */
+    void bakeMesh();
 };
 
 #endif // TILEMAP_MANAGER_H
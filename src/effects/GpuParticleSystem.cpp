@@ -0,0 +1,133 @@
+#include "GpuParticleSystem.h"
+#include "Particle.h"
+#include "render/GLState.h"
+#include "util/Util.h"
+#include <cmath>
+#include <cstddef>
+
+const std::vector<const char *> &GpuParticleSystem::Varyings()
+{
+    static const std::vector<const char *> varyings = { "outPosition", "outVelocity", "outLife", "outAlpha" };
+    return varyings;
+}
+
+GpuParticleSystem::GpuParticleSystem(const Shader &updateShader, const Shader &renderShader, const Texture2D &texture, unsigned int capacity)
+    : updateShader(updateShader)
+    , renderShader(renderShader)
+    , texture(texture)
+    , capacity(capacity)
+    , frame(0)
+    , quadVBO(0)
+    , current(0)
+{
+    init();
+}
+
+GpuParticleSystem::~GpuParticleSystem()
+{
+    for (unsigned int i = 0; i < 2; ++i) {
+        GLState::ForgetVertexArray(this->updateVAO[i]);
+        GLState::ForgetVertexArray(this->drawVAO[i]);
+    }
+    glDeleteVertexArrays(2, this->updateVAO);
+    glDeleteVertexArrays(2, this->drawVAO);
+    glDeleteBuffers(2, this->stateVBO);
+    glDeleteBuffers(1, &this->quadVBO);
+}
+
+void GpuParticleSystem::Update(float dt)
+{
+    const GpuParticleEmitter &e = this->Emitter;
+    this->updateShader.Use();
+    this->updateShader.Set(this->dtUniform, dt);
+    this->updateShader.Set(this->frameUniform, static_cast<int>(this->frame++));
+    this->updateShader.Set(this->originUniform, e.Origin);
+    this->updateShader.Set(this->spreadUniform, e.Spread);
+    this->updateShader.Set(this->velocityUniform, e.Velocity);
+    this->updateShader.Set(this->jitterUniform, e.VelocityJitter);
+    this->updateShader.Set(this->lifetimeUniform, e.Lifetime);
+    this->updateShader.Set(this->fadeUniform, e.Fade);
+    // a rate per second, turned into a chance for this step
+    this->updateShader.Set(this->respawnUniform, 1.0f - std::exp(-e.RespawnRate * dt));
+
+    unsigned int next = 1 - this->current;
+    glEnable(GL_RASTERIZER_DISCARD);
+    GLState::BindVertexArray(this->updateVAO[this->current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->stateVBO[next]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, this->capacity);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    glCheckError(__FILE__, __LINE__);
+    this->current = next;
+}
+
+void GpuParticleSystem::Draw()
+{
+    // use additive blending to give it a 'glow' effect
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+    this->renderShader.Use();
+    this->renderShader.Set(this->colorUniform, this->Emitter.Color);
+    this->renderShader.Set(this->sizeUniform, this->Emitter.Size);
+    this->texture.Bind();
+    GLState::BindVertexArray(this->drawVAO[this->current]);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->capacity);
+    glCheckError(__FILE__, __LINE__);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void GpuParticleSystem::init()
+{
+    this->dtUniform = this->updateShader.GetUniform<float>("dt");
+    this->frameUniform = this->updateShader.GetUniform<int>("frame");
+    this->originUniform = this->updateShader.GetUniform<glm::vec2>("origin");
+    this->spreadUniform = this->updateShader.GetUniform<glm::vec2>("spread");
+    this->velocityUniform = this->updateShader.GetUniform<glm::vec2>("baseVelocity");
+    this->jitterUniform = this->updateShader.GetUniform<glm::vec2>("velocityJitter");
+    this->lifetimeUniform = this->updateShader.GetUniform<float>("lifetime");
+    this->fadeUniform = this->updateShader.GetUniform<float>("fade");
+    this->respawnUniform = this->updateShader.GetUniform<float>("respawnChance");
+    this->colorUniform = this->renderShader.GetUniform<glm::vec3>("color");
+    this->sizeUniform = this->renderShader.GetUniform<float>("size");
+
+    this->quadVBO = CreateParticleQuad();
+
+    // every particle starts dead (all zero) and is emitted by the first updates
+    std::vector<State> initial(this->capacity, State{ glm::vec2(0.0f), glm::vec2(0.0f), 0.0f, 0.0f });
+    glGenBuffers(2, this->stateVBO);
+    glGenVertexArrays(2, this->updateVAO);
+    glGenVertexArrays(2, this->drawVAO);
+    for (unsigned int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_ARRAY_BUFFER, this->stateVBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(State), initial.data(), GL_DYNAMIC_COPY);
+
+        // update pass: one vertex per particle
+        GLState::BindVertexArray(this->updateVAO[i]);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Velocity));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Life));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Alpha));
+
+        // draw pass: the quad per vertex, the particle per instance
+        GLState::BindVertexArray(this->drawVAO[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glBindBuffer(GL_ARRAY_BUFFER, this->stateVBO[i]);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Position));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Life));
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(State), (void*)offsetof(State, Alpha));
+        glVertexAttribDivisor(3, 1);
+    }
+    glCheckError(__FILE__, __LINE__);
+}
@@ -0,0 +1,87 @@
+#ifndef GPU_PARTICLE_SYSTEM_H
+#define GPU_PARTICLE_SYSTEM_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "../render/Shader.h"
+#include "../asset/Texture2D.h"
+
+/**
+ * @brief Emission parameters of a GpuParticleSystem, uploaded as uniforms
+ */
+struct GpuParticleEmitter {
+    glm::vec2 Origin = glm::vec2(0.0f);         // centre of the emission area
+    glm::vec2 Spread = glm::vec2(0.0f);         // size of the emission area
+    glm::vec2 Velocity = glm::vec2(0.0f);       // like ParticleEmitterSettings, position -= velocity * dt
+    glm::vec2 VelocityJitter = glm::vec2(0.0f); // random range added to Velocity
+    float     Lifetime = 1.0f;                  // seconds
+    float     Fade = 1.0f;                      // alpha lost per second
+    float     RespawnRate = 1.0f;               // chance per second that a dead particle is emitted
+    glm::vec3 Color = glm::vec3(1.0f);
+    float     Size = 10.0f;
+};
+
+/**
+ * @brief Particles simulated entirely on the GPU
+ *
+ * State lives in two vertex buffers. Each Update runs the update program
+ * (particle_update.vs) over one buffer with transform feedback writing into
+ * the other, then swaps them; Draw instances the quad over the newest
+ * buffer (particle_gpu.vs). The CPU only sets uniforms, so the cost doesn't
+ * grow with the particle count. Needs nothing past GL 3.3.
+ */
+class GpuParticleSystem {
+public:
+    GpuParticleEmitter Emitter;
+
+    /**
+     * @brief Constructor
+     * @param updateShader Program loaded with ResourceManager::LoadFeedbackShader
+     */
+    GpuParticleSystem(const Shader &updateShader, const Shader &renderShader, const Texture2D &texture, unsigned int capacity);
+    ~GpuParticleSystem();
+    GpuParticleSystem(const GpuParticleSystem &) = delete;
+    GpuParticleSystem &operator=(const GpuParticleSystem &) = delete;
+
+    /**
+     * @brief Advances every particle by dt
+     */
+    void Update(float dt);
+
+    /**
+     * @brief Draw all particles
+     */
+    void Draw();
+
+    unsigned int Capacity() const { return capacity; }
+
+    // names of the update program's outputs, in buffer order
+    static const std::vector<const char *> &Varyings();
+
+private:
+    // one particle as stored in the state buffers
+    struct State {
+        glm::vec2 Position, Velocity;
+        float     Life, Alpha;
+    };
+
+    Shader       updateShader, renderShader;
+    Texture2D    texture;
+    unsigned int capacity;
+    unsigned int frame;
+    // ping-pong state; current is the one holding the latest step
+    unsigned int stateVBO[2], updateVAO[2], drawVAO[2];
+    unsigned int quadVBO;
+    unsigned int current;
+    Uniform<float>     dtUniform, lifetimeUniform, fadeUniform, respawnUniform, sizeUniform;
+    Uniform<int>       frameUniform;
+    Uniform<glm::vec2> originUniform, spreadUniform, velocityUniform, jitterUniform;
+    Uniform<glm::vec3> colorUniform;
+
+    /**
+     * @brief Initialize the buffers and vertex attributes
+     */
+    void init();
+};
+
+#endif // GPU_PARTICLE_SYSTEM_H
@@ -0,0 +1,47 @@
+#include "ParticleKernel.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_SSE2
+#include <emmintrin.h>
+#endif
+
+void UpdateParticlesScalar(const ParticleArrays &p, size_t begin, size_t end, float dt, float fade)
+{
+    for (size_t i = begin; i < end; ++i) {
+        p.Life[i] = std::max(0.0f, p.Life[i] - dt);
+        p.PositionX[i] -= p.VelocityX[i] * dt;
+        p.PositionY[i] -= p.VelocityY[i] * dt;
+        p.Alpha[i] -= fade * dt;
+    }
+}
+
+void UpdateParticles(const ParticleArrays &p, size_t count, float dt, float fade)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 step = _mm256_set1_ps(dt);
+    const __m256 fadeStep = _mm256_set1_ps(fade * dt);
+    const __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(p.Life + i, _mm256_max_ps(zero, _mm256_sub_ps(_mm256_loadu_ps(p.Life + i), step)));
+        _mm256_storeu_ps(p.PositionX + i, _mm256_sub_ps(_mm256_loadu_ps(p.PositionX + i), _mm256_mul_ps(_mm256_loadu_ps(p.VelocityX + i), step)));
+        _mm256_storeu_ps(p.PositionY + i, _mm256_sub_ps(_mm256_loadu_ps(p.PositionY + i), _mm256_mul_ps(_mm256_loadu_ps(p.VelocityY + i), step)));
+        _mm256_storeu_ps(p.Alpha + i, _mm256_sub_ps(_mm256_loadu_ps(p.Alpha + i), fadeStep));
+    }
+#elif defined(PARTICLES_SSE2)
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 fadeStep = _mm_set1_ps(fade * dt);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(p.Life + i, _mm_max_ps(zero, _mm_sub_ps(_mm_loadu_ps(p.Life + i), step)));
+        _mm_storeu_ps(p.PositionX + i, _mm_sub_ps(_mm_loadu_ps(p.PositionX + i), _mm_mul_ps(_mm_loadu_ps(p.VelocityX + i), step)));
+        _mm_storeu_ps(p.PositionY + i, _mm_sub_ps(_mm_loadu_ps(p.PositionY + i), _mm_mul_ps(_mm_loadu_ps(p.VelocityY + i), step)));
+        _mm_storeu_ps(p.Alpha + i, _mm_sub_ps(_mm_loadu_ps(p.Alpha + i), fadeStep));
+    }
+#endif
+    UpdateParticlesScalar(p, i, count, dt, fade);
+}
@@ -0,0 +1,25 @@
+#ifndef PARTICLE_KERNEL_H
+#define PARTICLE_KERNEL_H
+
+#include <cstddef>
+
+// Particle state as separate arrays, one element per particle, so the
+// update streams through memory and maps onto SIMD lanes
+struct ParticleArrays
+{
+    float *PositionX, *PositionY;
+    float *VelocityX, *VelocityY;
+    float *Alpha;
+    float *Life;
+};
+
+// Advances count particles by dt: life runs down to 0, position moves
+// against the velocity and alpha fades by fade per second. Every particle
+// takes the same path; dead ones are left for the caller to compact away.
+// Uses AVX2 when the build enables it (ENABLE_AVX2), SSE2 on other x86
+// builds and plain C++ elsewhere.
+void UpdateParticles(const ParticleArrays &particles, size_t count, float dt, float fade);
+// The plain C++ version, also used for the tail the vector loops leave
+void UpdateParticlesScalar(const ParticleArrays &particles, size_t begin, size_t end, float dt, float fade);
+
+#endif
@@ -0,0 +1,274 @@
+#include "ParticleSystem.h"
+#include "render/GLState.h"
+#include "util/Random.h"
+#include "util/Util.h"
+#include <algorithm>
+#include <cstddef>
+
+ParticleSystem::ParticleSystem(const Shader &shader)
+    : shader(shader)
+    , VAO(0)
+    , quadVBO(0)
+    , instanceVBO(0)
+    , instanceCapacity(0)
+{
+    init();
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    GLState::ForgetVertexArray(this->VAO);
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->quadVBO);
+    glDeleteBuffers(1, &this->instanceVBO);
+}
+
+ParticleSystem::EmitterId ParticleSystem::AddEmitter(const Texture2D &texture, unsigned int capacity, const ParticleEmitterSettings &settings, bool transient)
+{
+    Emitter emitter{ settings, texture };
+    emitter.Base = this->allocate(capacity);
+    emitter.Capacity = capacity;
+    emitter.Transient = transient;
+    emitter.Live = true;
+    // reuse the slot of a removed emitter
+    for (EmitterId id = 0; id < this->emitters.size(); ++id) {
+        if (!this->emitters[id].Live) {
+            this->emitters[id] = emitter;
+            return id;
+        }
+    }
+    this->emitters.push_back(emitter);
+    return static_cast<EmitterId>(this->emitters.size() - 1);
+}
+
+void ParticleSystem::RemoveEmitter(EmitterId id)
+{
+    Emitter &emitter = this->emitters[id];
+    if (!emitter.Live)
+        return;
+    this->freeRanges.push_back({ emitter.Base, emitter.Capacity });
+    emitter.Live = false;
+    emitter.Alive = 0;
+    emitter.Target = nullptr;
+}
+
+void ParticleSystem::Attach(EmitterId id, const GameObject *object)
+{
+    this->emitters[id].Target = object;
+}
+
+void ParticleSystem::SetPosition(EmitterId id, glm::vec2 position)
+{
+    this->emitters[id].Target = nullptr;
+    this->emitters[id].Position = position;
+}
+
+void ParticleSystem::SetActive(EmitterId id, bool active)
+{
+    this->emitters[id].Active = active;
+    this->emitters[id].Pending = 0.0f;
+}
+
+void ParticleSystem::Burst(EmitterId id, unsigned int count)
+{
+    this->spawn(this->emitters[id], count);
+}
+
+void ParticleSystem::Update(float dt)
+{
+    ParticleArrays pool = this->arrays();
+    for (EmitterId id = 0; id < this->emitters.size(); ++id) {
+        Emitter &emitter = this->emitters[id];
+        if (!emitter.Live)
+            continue;
+        if (emitter.Active && emitter.Settings.Rate > 0.0f) {
+            emitter.Pending += emitter.Settings.Rate * dt;
+            unsigned int count = static_cast<unsigned int>(emitter.Pending);
+            emitter.Pending -= count;
+            this->spawn(emitter, count);
+        }
+        // only the live part of the emitter's range is touched
+        ParticleArrays range = { pool.PositionX + emitter.Base, pool.PositionY + emitter.Base,
+                                 pool.VelocityX + emitter.Base, pool.VelocityY + emitter.Base,
+                                 pool.Alpha + emitter.Base, pool.Life + emitter.Base };
+        UpdateParticles(range, emitter.Alive, dt, emitter.Settings.Fade);
+        this->compact(emitter);
+        if (emitter.Transient && emitter.Alive == 0 && (!emitter.Active || emitter.Settings.Rate <= 0.0f))
+            this->RemoveEmitter(id);
+    }
+}
+
+void ParticleSystem::Draw()
+{
+    unsigned int total = this->Alive();
+    if (total == 0)
+        return;
+
+    GLState::BindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    // orphan last frame's instances so the map doesn't wait on their draw
+    this->instanceCapacity = std::max(this->instanceCapacity, total);
+    glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
+    ParticleInstance *instances = static_cast<ParticleInstance *>(
+        glMapBufferRange(GL_ARRAY_BUFFER, 0, total * sizeof(ParticleInstance), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!instances)
+        return;
+    unsigned int written = 0;
+    for (const Emitter &emitter : this->emitters) {
+        if (!emitter.Live)
+            continue;
+        for (unsigned int i = emitter.Base; i < emitter.Base + emitter.Alive; ++i) {
+            instances[written].Offset = glm::vec2(this->positionX[i], this->positionY[i]);
+            instances[written].Color = glm::vec4(glm::vec3(this->shade[i]), this->alpha[i]);
+            written++;
+        }
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    // use additive blending to give it a 'glow' effect
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+    this->shader.Use();
+    // one draw per run of emitters sharing a texture; GL 3.3 has no base
+    // instance, so the instance attributes are pointed at the run instead
+    unsigned int first = 0, count = 0;
+    GLuint texture = 0;
+    auto flush = [&]() {
+        if (count == 0)
+            return;
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+                              (void*)(first * sizeof(ParticleInstance) + offsetof(ParticleInstance, Offset)));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+                              (void*)(first * sizeof(ParticleInstance) + offsetof(ParticleInstance, Color)));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+        first += count;
+        count = 0;
+    };
+    for (const Emitter &emitter : this->emitters) {
+        if (!emitter.Live || emitter.Alive == 0)
+            continue;
+        if (emitter.Texture.ID != texture) {
+            flush();
+            texture = emitter.Texture.ID;
+            emitter.Texture.Bind();
+        }
+        count += emitter.Alive;
+    }
+    flush();
+    glCheckError(__FILE__, __LINE__);
+    // don't forget to reset to default blending mode
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+unsigned int ParticleSystem::Alive() const
+{
+    unsigned int alive = 0;
+    for (const Emitter &emitter : this->emitters)
+        alive += emitter.Live ? emitter.Alive : 0;
+    return alive;
+}
+
+unsigned int ParticleSystem::Emitters() const
+{
+    unsigned int count = 0;
+    for (const Emitter &emitter : this->emitters)
+        count += emitter.Live ? 1 : 0;
+    return count;
+}
+
+void ParticleSystem::init()
+{
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->instanceVBO);
+    GLState::BindVertexArray(this->VAO);
+    this->quadVBO = CreateParticleQuad();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // per-instance offset and color; Draw points them at each run
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Offset));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Color));
+    glVertexAttribDivisor(2, 1);
+    glCheckError(__FILE__, __LINE__);
+}
+
+unsigned int ParticleSystem::allocate(unsigned int capacity)
+{
+    // first released range that fits; the unused tail is kept as a range of its own
+    for (size_t i = 0; i < this->freeRanges.size(); ++i) {
+        Range range = this->freeRanges[i];
+        if (range.Capacity < capacity)
+            continue;
+        this->freeRanges.erase(this->freeRanges.begin() + i);
+        if (range.Capacity > capacity)
+            this->freeRanges.push_back({ range.Base + capacity, range.Capacity - capacity });
+        return range.Base;
+    }
+    unsigned int base = static_cast<unsigned int>(this->life.size());
+    for (std::vector<float> *array : { &this->positionX, &this->positionY, &this->velocityX, &this->velocityY,
+                                       &this->alpha, &this->life, &this->shade })
+        array->resize(base + capacity, 0.0f);
+    return base;
+}
+
+void ParticleSystem::spawn(Emitter &emitter, unsigned int count)
+{
+    if (!emitter.Live || emitter.Capacity == 0)
+        return;
+    const ParticleEmitterSettings &s = emitter.Settings;
+    glm::vec2 origin = emitter.Position + s.Offset;
+    glm::vec2 velocity = s.Velocity;
+    if (emitter.Target) {
+        origin += emitter.Target->Position;
+        velocity += emitter.Target->Velocity * s.Inherit;
+    }
+    std::mt19937 &random = Random::getGenerator();
+    std::uniform_real_distribution<float> jitter(-s.Spread, s.Spread);
+    std::uniform_real_distribution<float> shade(s.MinShade, s.MaxShade);
+    for (unsigned int n = 0; n < count; ++n) {
+        // the next slot after the live ones, or overwrite around the ring when full
+        unsigned int i;
+        if (emitter.Alive < emitter.Capacity) {
+            i = emitter.Base + emitter.Alive++;
+        } else {
+            i = emitter.Base + emitter.Cursor;
+            emitter.Cursor = (emitter.Cursor + 1) % emitter.Capacity;
+        }
+        this->positionX[i] = origin.x + jitter(random);
+        this->positionY[i] = origin.y + jitter(random);
+        this->velocityX[i] = velocity.x;
+        this->velocityY[i] = velocity.y;
+        this->alpha[i] = 1.0f;
+        this->life[i] = s.Lifetime;
+        this->shade[i] = shade(random);
+    }
+}
+
+void ParticleSystem::compact(Emitter &emitter)
+{
+    // swap the last live particle into each dead slot; order doesn't matter
+    // with additive blending
+    unsigned int i = emitter.Base;
+    while (i < emitter.Base + emitter.Alive) {
+        if (this->life[i] > 0.0f) {
+            ++i;
+            continue;
+        }
+        unsigned int last = emitter.Base + --emitter.Alive;
+        this->positionX[i] = this->positionX[last];
+        this->positionY[i] = this->positionY[last];
+        this->velocityX[i] = this->velocityX[last];
+        this->velocityY[i] = this->velocityY[last];
+        this->alpha[i] = this->alpha[last];
+        this->life[i] = this->life[last];
+        this->shade[i] = this->shade[last];
+    }
+}
+
+ParticleArrays ParticleSystem::arrays()
+{
+    return { this->positionX.data(), this->positionY.data(), this->velocityX.data(), this->velocityY.data(),
+             this->alpha.data(), this->life.data() };
+}
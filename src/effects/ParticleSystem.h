@@ -0,0 +1,131 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "../render/Shader.h"
+#include "../asset/Texture2D.h"
+#include "../game/GameObject.h"
+#include "Particle.h"
+#include "ParticleKernel.h"
+
+/**
+ * @brief How an emitter spawns and moves its particles
+ */
+struct ParticleEmitterSettings {
+    float     Rate = 0.0f;                  // particles per second while active; 0 for burst-only emitters
+    float     Lifetime = 1.0f;              // seconds
+    float     Fade = 2.5f;                  // alpha lost per second
+    float     Spread = 5.0f;                // spawn position jitter, +- on each axis
+    glm::vec2 Offset = glm::vec2(0.0f);     // from the attached object or the world point
+    glm::vec2 Velocity = glm::vec2(0.0f);   // position -= velocity * dt
+    float     Inherit = 0.0f;               // share of the attached object's velocity added to Velocity
+    float     MinShade = 0.5f, MaxShade = 1.5f;
+};
+
+/**
+ * @brief Runs any number of independent particle emitters
+ *
+ * Every emitter owns a fixed range of one shared structure-of-arrays pool,
+ * kept compacted (live particles first), so spawning is O(1): the next
+ * slot after the live ones, or, when the range is full, the slot under a
+ * ring cursor. Update advances all emitters in one pass over the live
+ * ranges with the SIMD kernel; Draw streams every live particle into one
+ * instance buffer and issues one instanced draw per run of emitters
+ * sharing a texture.
+ *
+ * Emitters either follow a GameObject or sit at a world point, and emit
+ * continuously (Rate) and/or in bursts.
+ */
+class ParticleSystem {
+public:
+    typedef unsigned int EmitterId;
+
+    /**
+     * @brief Constructor
+     * @param shader The instanced particle shader (particle_instanced.vs)
+     */
+    explicit ParticleSystem(const Shader &shader);
+    ~ParticleSystem();
+    ParticleSystem(const ParticleSystem &) = delete;
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    /**
+     * @brief Adds an emitter at the origin with room for capacity live particles
+     * @param transient Removed by Update once it's inactive and has no live particles
+     */
+    EmitterId AddEmitter(const Texture2D &texture, unsigned int capacity, const ParticleEmitterSettings &settings,
+                         bool transient = false);
+    void RemoveEmitter(EmitterId id);
+
+    /**
+     * @brief Makes the emitter follow object, which must outlive it or be detached
+     */
+    void Attach(EmitterId id, const GameObject *object);
+    /**
+     * @brief Moves the emitter to a world point, detaching it
+     */
+    void SetPosition(EmitterId id, glm::vec2 position);
+    /**
+     * @brief Starts or stops continuous emission
+     */
+    void SetActive(EmitterId id, bool active);
+    /**
+     * @brief Spawns count particles at once
+     */
+    void Burst(EmitterId id, unsigned int count);
+    ParticleEmitterSettings &Settings(EmitterId id) { return emitters[id].Settings; }
+
+    /**
+     * @brief Spawns, advances and compacts every emitter
+     */
+    void Update(float dt);
+
+    /**
+     * @brief Draw all particles
+     */
+    void Draw();
+
+    /**
+     * @brief Live particles over all emitters
+     */
+    unsigned int Alive() const;
+    unsigned int Emitters() const;
+
+private:
+    struct Emitter {
+        ParticleEmitterSettings Settings;
+        Texture2D               Texture;
+        const GameObject       *Target = nullptr;
+        glm::vec2               Position = glm::vec2(0.0f);
+        unsigned int            Base = 0, Capacity = 0;
+        unsigned int            Alive = 0;
+        unsigned int            Cursor = 0;     // ring position once the range is full
+        float                   Pending = 0.0f; // fractional particles owed by Rate
+        bool                    Active = true;
+        bool                    Transient = false;
+        bool                    Live = false;
+    };
+    // a released pool range, reused by the next emitter that fits
+    struct Range {
+        unsigned int Base, Capacity;
+    };
+
+    Shader shader;
+    std::vector<Emitter> emitters;
+    std::vector<Range> freeRanges;
+    // the shared pool; emitters own [Base, Base + Capacity)
+    std::vector<float> positionX, positionY;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> alpha, life, shade;
+    unsigned int VAO, quadVBO, instanceVBO;
+    unsigned int instanceCapacity;
+
+    void init();
+    unsigned int allocate(unsigned int capacity);
+    void spawn(Emitter &emitter, unsigned int count);
+    void compact(Emitter &emitter);
+    ParticleArrays arrays();
+};
+
+#endif // PARTICLE_SYSTEM_H
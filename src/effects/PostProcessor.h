@@ -28,12 +28,14 @@ public:
     // should be called after rendering the game, so it stores all the rendered data into a texture object
     void EndRender();
     // renders the PostProcessor texture quad (as a screen-encompassing large sprite)
-    void Render(float time);
+    // (time comes from the FrameData block)
+    void Render();
 private:
     // render state
     unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
     unsigned int RBO; // RBO is used for multisampled color buffer
     unsigned int VAO;
+    Uniform<int>   confuseUniform, chaosUniform, shakeUniform;
     // initialize quad for rendering postprocessing texture
     void initRenderData();
 };
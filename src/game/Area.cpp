@@ -1,7 +1,6 @@
 #include "Area.h"
 #include "Game.h"
-#include <fstream>
-#include <sstream>
+#include <filesystem>
 #include <iostream>
 
 extern bool debug;  // Make the debug variable accessible
@@ -11,35 +10,30 @@ Area::Area(unsigned int levelWidth, unsigned int levelHeight) {
     Height = levelHeight;
 }
 
-// Function to read tile data from a file
-std::vector<std::vector<unsigned int>> Area::readTileData(const std::string& filename) {
-    std::vector<std::vector<unsigned int>> tileData;
-    std::ifstream file(ResourceManager::root + filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Could not open the file: " << filename << std::endl;
-        return tileData;
-    }
+void Area::LoadTilemap(const char* file, const char* texturePath, const std::string& bgTexturePath, unsigned int tileWidth, unsigned int tileHeight) {
+    namespace fs = std::filesystem;
+    std::string textPath = ResourceManager::root + file;
+    std::string binaryPath = fs::path(textPath).extension() == ".lvlb" ? textPath : textPath + "b";
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream stream(line);
-        std::vector<unsigned int> row;
-        unsigned int tile;
-        while (stream >> tile) {
-            row.push_back(tile);
-        }
-        tileData.push_back(row);
+    // Refresh the binary when the text version has been edited since
+    std::error_code error;
+    if (binaryPath != textPath && fs::exists(textPath, error)
+        && (!fs::exists(binaryPath, error) || fs::last_write_time(textPath, error) > fs::last_write_time(binaryPath, error))) {
+        LevelFile::Convert(textPath, binaryPath);
     }
 
-    file.close();
-    return tileData;
-}
-
-void Area::LoadTilemap(const char* file, const char* texturePath, const std::string& bgTexturePath, unsigned int tileWidth, unsigned int tileHeight) {
-    std::vector<std::vector<unsigned int>> data = readTileData(file);
     tilemapManager = std::make_shared<TilemapManager>(texturePath, bgTexturePath, tileWidth, tileHeight); // Adjust the texture path and tile dimensions as needed
-    tilemapManager->LoadTilemap(data, Width, Height);
+    LevelFile level;
+    AssetData data;
+    if (ResourceManager::ReadAsset(binaryPath, data) && level.Open(std::move(data))) {
+        tilemapManager->LoadTilemap(level);
+    } else {
+        // read-only install or a broken binary; parse the text instead
+        AssetData text;
+        if (!ResourceManager::ReadAsset(textPath, text))
+            std::cerr << "Could not open the file: " << textPath << std::endl;
+        tilemapManager->LoadTilemap(LevelFile::ParseText(text.Data(), text.Size()), Width, Height);
+    }
 }
 
 void Area::Draw(SpriteRenderer& renderer) {
@@ -84,6 +78,17 @@ GameObject* Area::GetRandomEnemy() {
     if (debug) std::cout << "GetRandomEnemy: Failed to get valid enemy" << std::endl;
     return nullptr;
 }
+std::vector<GameObject*> Area::EncounterTable() const {
+    // mirrors GetRandomEnemy: slot 0 is never rolled
+    std::vector<GameObject*> table;
+    if (enemies.size() < 2)
+        return table;
+    for (size_t i = 1; i < enemies.size(); ++i) {
+        if (enemies[i])
+            table.push_back(enemies[i].get());
+    }
+    return table;
+}
 bool Area::IsCompleted() const {
     return true;
 }
@@ -22,7 +22,9 @@ public:
     // Constructor
     Area(unsigned int levelWidth, unsigned int levelHeight);
 
-    // Loads an area from a tilemap file (only applicable for GAME mode)
+    // Loads an area from a tilemap file (only applicable for GAME mode).
+    // A text level is converted to <file>b (.lvlb) the first time, or when
+    // it's newer than the binary, and the binary is mapped from then on
     void LoadTilemap(const char* file, const char* texturePath, const std::string& bgTexturePath, unsigned int tileWidth, unsigned int tileHeight);
 
     // Renders the area or UI based on the mode
@@ -37,12 +39,11 @@ public:
     // Cleans up resources
     void Clean();
     GameObject* GetRandomEnemy();
+    // Every enemy GetRandomEnemy can return
+    std::vector<GameObject*> EncounterTable() const;
     std::shared_ptr<TilemapManager> tilemapManager; // Tilemap manager for handling static tiles in GAME mode
     std::vector<std::shared_ptr<GameObject>> enemies;
 
-private:
-    // Initializes the area from tile data
-    std::vector<std::vector<unsigned int>> readTileData(const std::string& filename);
 };
 
 #endif // AREA_H
\ No newline at end of file
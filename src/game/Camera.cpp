@@ -46,6 +46,13 @@ glm::mat4 Camera::GetViewMatrix() const {
     return View;
 }
 
+void Camera::GetVisibleRect(glm::vec2& min, glm::vec2& max) const {
+    // the view maps world to screen as p * Zoom - Position, and the
+    // projection shows [0, Size]
+    min = Position / Zoom;
+    max = (Position + Size) / Zoom;
+}
+
 void Camera::UpdateViewMatrix() {
     View = glm::translate(glm::mat4(1.0f), glm::vec3(-Position, 0.0f));
     View = glm::scale(View, glm::vec3(Zoom, Zoom, 1.0f));
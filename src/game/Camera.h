@@ -20,6 +20,11 @@ public:
     void Update(float dt); // Update logic, can include animations or transitions
 
     glm::mat4 GetViewMatrix() const;
+    glm::vec2 GetPosition() const { return Position; }
+    glm::vec2 GetSize() const { return Size; }
+    float GetZoom() const { return Zoom; }
+    // World-space rectangle currently on screen
+    void GetVisibleRect(glm::vec2& min, glm::vec2& max) const;
 
 private:
     void UpdateViewMatrix();
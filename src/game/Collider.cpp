@@ -19,49 +19,7 @@ void Collider::Update(std::shared_ptr<Player>& player, float deltaTime) {
 }
 
 void Collider::HandleAxisCollisions(std::shared_ptr<Player>& player, const glm::vec2& oldPosition, [[maybe_unused]] bool checkX) {
-    if (!levelWalls) {
-        std::cerr << "TilemapManager not set for collision detection!" << std::endl;
-        return;
-    }
-
-    // Get actual bounding box values
-    glm::vec2 actualSize = (boundingBoxSize == glm::vec2(0.0f)) ? player->Size : boundingBoxSize;
-    glm::vec2 boxPosition = player->Position + boundingBoxOffset;
-    
-    for (const auto& tile : levelWalls->tiles) {
-        if (!tile.IsSolid) {
-            continue; // Skip non-solid tiles
-        }
-
-        // Check for AABB collision using the bounding box
-        if (CheckCollision(boxPosition, actualSize, tile.Position, tile.Size)) {
-            // Calculate overlap
-            float overlapX = std::min(boxPosition.x + actualSize.x, tile.Position.x + tile.Size.x) -
-                            std::max(boxPosition.x, tile.Position.x);
-            float overlapY = std::min(boxPosition.y + actualSize.y, tile.Position.y + tile.Size.y) -
-                            std::max(boxPosition.y, tile.Position.y);
-
-            // Determine which axis to resolve based on the smallest overlap
-            if (overlapX < overlapY) {
-                // Resolve X-axis collision
-                if (oldPosition.x + boundingBoxOffset.x < tile.Position.x) {
-                    player->Position.x = tile.Position.x - actualSize.x - boundingBoxOffset.x;
-                }
-                else {
-                    player->Position.x = tile.Position.x + tile.Size.x - boundingBoxOffset.x;
-                }
-            }
-            else {
-                // Resolve Y-axis collision
-                if (oldPosition.y + boundingBoxOffset.y < tile.Position.y) {
-                    player->Position.y = tile.Position.y - actualSize.y - boundingBoxOffset.y;
-                }
-                else {
-                    player->Position.y = tile.Position.y + tile.Size.y - boundingBoxOffset.y;
-                }
-            }
-        }
-    }
+    HandleCollisions(player, oldPosition);
 }
 
 void Collider::HandleCollisions(std::shared_ptr<Player>& player, const glm::vec2& oldPosition) {
@@ -73,12 +31,9 @@ void Collider::HandleCollisions(std::shared_ptr<Player>& player, const glm::vec2
     // Get actual bounding box values
     glm::vec2 actualSize = (boundingBoxSize == glm::vec2(0.0f)) ? player->Size : boundingBoxSize;
     glm::vec2 boxPosition = player->Position + boundingBoxOffset;
-    
-    for (const auto& tile : levelWalls->tiles) {
-        if (!tile.IsSolid) {
-            continue; // Skip non-solid tiles
-        }
 
+    // Only the solid tiles under the bounding box are visited
+    levelWalls->ForEachSolidTile(boxPosition, actualSize, [&](const TilemapManager::Tile& tile) {
         // Check for AABB collision using the bounding box
         if (CheckCollision(boxPosition, actualSize, tile.Position, tile.Size)) {
             // Calculate overlap
@@ -107,7 +62,7 @@ void Collider::HandleCollisions(std::shared_ptr<Player>& player, const glm::vec2
                 }
             }
         }
-    }
+    });
 }
 
 void Collider::SetBoundingBoxOffset(const glm::vec2& offset) {
@@ -0,0 +1,30 @@
+#include "EncounterPrefetcher.h"
+
+#include <algorithm>
+
+#include "Area.h"
+#include "asset/ResourceManager.h"
+#include "asset/TextureResidency.h"
+
+void EncounterPrefetcher::SetArea(const Area &area)
+{
+    this->textures.clear();
+    for (const GameObject *enemy : area.EncounterTable()) {
+        // atlas pages (where the monsters currently live) are never evicted,
+        // so there is nothing to warm for them
+        const auto &pages = ResourceManager::Atlas.Pages();
+        if (std::any_of(pages.begin(), pages.end(), [enemy](const std::shared_ptr<Texture2D> &page) { return page->ID == enemy->Sprite.ID; }))
+            continue;
+        if (std::find(this->textures.begin(), this->textures.end(), enemy->Sprite.ID) == this->textures.end())
+            this->textures.push_back(enemy->Sprite.ID);
+    }
+}
+
+void EncounterPrefetcher::Update(float progress)
+{
+    this->urgent = progress >= URGENT_PROGRESS;
+    if (progress < WARM_PROGRESS)
+        return;
+    for (GLuint texture : this->textures)
+        TextureResidency::Prefetch(texture, this->urgent);
+}
@@ -0,0 +1,37 @@
+#ifndef ENCOUNTER_PREFETCHER_H
+#define ENCOUNTER_PREFETCHER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+class Area;
+
+// Warms the textures of every monster the current area's encounter table
+// can roll, so entering a battle never waits on a reload. Driven by how
+// close the step counter is to the encounter roll: past WARM_PROGRESS any
+// evicted candidate is reloaded in the background, past URGENT_PROGRESS
+// the reloads jump the decode queue and Urgent() asks for a bigger upload
+// budget. Candidates are touched while warm, so the residency manager
+// won't evict them right before they're needed. Only textures the
+// residency manager can evict are candidates; monsters drawn from an atlas
+// page are always resident and are skipped.
+class EncounterPrefetcher
+{
+public:
+    static constexpr float WARM_PROGRESS = 0.5f;
+    static constexpr float URGENT_PROGRESS = 0.85f;
+
+    // collects the candidates; call again whenever the area's enemies change
+    void SetArea(const Area &area);
+    // progress is the step counter over the step threshold, 0..1
+    void Update(float progress);
+    bool Urgent() const { return urgent; }
+    size_t Candidates() const { return textures.size(); }
+
+private:
+    std::vector<GLuint> textures;
+    bool                urgent = false;
+};
+
+#endif
@@ -15,19 +15,34 @@
 #include "ui/Gui.h"
 #include "gamemode.h"
 #include "types.h"
-#include "effects/Particle.h"
+#include "effects/ParticleSystem.h"
+#include "effects/GpuParticleSystem.h"
 #include "Collider.h"
 #include "input/Input.h"
 #include "Area.h"
 #include "ui/Battle.h"
 #include "asset/TilemapManager.h"
 #include "util/Random.h"
+#include "render/GLState.h"
+#include "render/FrameUniforms.h"
+#include "asset/TextureLoader.h"
+#include "asset/TextureResidency.h"
 
 // Initial size of the player paddle
 const glm::vec2 PLAYER_SIZE(300.0f, 300.0f);
 // Initial velocity of the player paddle
 const float PLAYER_VELOCITY(12500.0f);
 bool gameOver = false;
+// Time each frame may spend uploading textures that finished decoding
+const double TEXTURE_UPLOAD_BUDGET_MS = 2.0;
+// Particles the player's trail emits
+const float TRAIL_PARTICLES_PER_SECOND = 240.0f;
+// Particles simulated by the ambient GPU effect
+const unsigned int GPU_PARTICLE_COUNT = 100000;
+// Upload time per frame while an encounter is about to be rolled
+const double URGENT_UPLOAD_BUDGET_MS = 6.0;
+// Texture memory kept resident before idle textures are evicted
+const size_t TEXTURE_MEMORY_BUDGET = 192u * 1024u * 1024u;
 // Add this in your Game constructor or Init method
 std::random_device rd;
 std::mt19937 gen = std::mt19937(rd());  // Seeded generator
@@ -66,16 +81,28 @@ void Game::Init()
     frameCount = 0;
     fps = 0.0f;
 
-    // Load shaders
-    ResourceManager::LoadShader("sprite/vertex.glsl", "sprite/fragment.glsl", nullptr, "sprite");
-    ResourceManager::LoadShader("particle.vs", "particle.fs", nullptr, "particle");
-
-    // Configure shaders
+    // Load shaders; they compile as one batch, or come from the binary cache
+    ResourceManager::QueueShader("sprite/vertex.glsl", "sprite/fragment.glsl", nullptr, "sprite");
+    ResourceManager::QueueShader("particle_instanced.vs", "particle.fs", nullptr, "particle_instanced");
+    ResourceManager::QueueShader("particle_gpu.vs", "particle.fs", nullptr, "particle_gpu");
+    ResourceManager::QueueShader("sprite/batch_vertex.glsl", "sprite/batch_fragment.glsl", nullptr, "sprite_batch");
+    ResourceManager::QueueShader("sprite/instanced_vertex.glsl", "sprite/batch_fragment.glsl", nullptr, "sprite_instanced");
+    ResourceManager::QueueShader("tilemap/vertex.glsl", "tilemap/fragment.glsl", nullptr, "tilemap");
+    ResourceManager::QueueShader("background/vertex.glsl", "background/fragment.glsl", nullptr, "background");
+    ResourceManager::LoadQueuedShaders();
+    ResourceManager::LoadFeedbackShader("particle_update.vs", GpuParticleSystem::Varyings(), "particle_update");
+
+    // Configure shaders; projection and view live in the shared FrameData block
     glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width),
         static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
+    FrameUniforms::Init();
+    FrameUniforms::SetProjection(projection, glm::vec2(this->Width, this->Height));
     ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-    ResourceManager::GetShader("particle").Use().SetMatrix4("projection", projection);
+    ResourceManager::GetShader("sprite_batch").Use().SetInteger("image", 0);
+    ResourceManager::GetShader("sprite_instanced").Use().SetInteger("image", 0);
+    ResourceManager::GetShader("tilemap").Use().SetInteger("atlas", 0);
+    ResourceManager::GetShader("tilemap").SetInteger("tileIndex", 1);
+    ResourceManager::GetShader("background").Use().SetInteger("image", 0);
 
     // Initialize renderer
     const std::vector<float> vertices = {
@@ -92,16 +119,26 @@ void Game::Init()
     Renderer = std::make_unique<SpriteRenderer>(
         ResourceManager::GetShader("sprite"), vertices
     );
-
-    // Load textures
-    ResourceManager::LoadTexture2D("particle.png", "particle");
-
-    // Initialize particle generator
-    Particles = std::make_unique<ParticleGenerator>(
-        ResourceManager::GetShader("particle"), 
-        ResourceManager::GetTexture2D("particle"), 
-        1500
-    );
+    Renderer->SetBatchShader(ResourceManager::GetShader("sprite_batch"));
+    Renderer->SetInstanceShader(ResourceManager::GetShader("sprite_instanced"));
+
+    // Load textures; everything in textures/ decodes in the background and
+    // whatever isn't needed during Init is uploaded over the next frames
+    TextureLoader::Init();
+    TextureResidency::Budget = TEXTURE_MEMORY_BUDGET;
+    // Monsters share one atlas page so the battle and overworld batch them
+    // together; packed files are left out of the standalone loads below
+    ResourceManager::BuildAtlas({ "frog.png", "turtle.png", "scorpion.png", "wolf.png", "insect.png" });
+    ResourceManager::LoadAllTexturesFromDirectory();
+
+    // Initialize particles
+    Particles = std::make_unique<ParticleSystem>(ResourceManager::GetShader("particle_instanced"));
+    // the player's trail; it's attached to the player in ResetPlayer
+    ParticleEmitterSettings trail;
+    trail.Rate = TRAIL_PARTICLES_PER_SECOND;
+    trail.Offset = glm::vec2(60.0f, 135.0f);
+    trail.Inherit = 0.1f;
+    trailEmitter = Particles->AddEmitter(ResourceManager::GetTexture2D("particle"), 1500, trail);
 
     // Initialize game resources
     InitializeGameResources();
@@ -125,7 +162,9 @@ void Game::InitializeGameResources()
         currentArea = std::make_shared<Area>(Width, Height);
     }
     currentArea->LoadTilemap("levels/main.lvl", "tiles.png", "bg.png", 7, 7);
+    currentArea->tilemapManager->SetBackgroundShader(ResourceManager::GetShader("background"));
     currentArea->enemies = monsters;
+    Prefetcher.SetArea(*currentArea);
 
     // Initialize collision system
     if (!Collision) {
@@ -135,8 +174,26 @@ void Game::InitializeGameResources()
     Collision->SetBoundingBoxSize(glm::vec2(60.0,120.0f));
 }
 
+// Render queue callbacks for the parts of the frame that draw themselves
+static void drawArea(SpriteRenderer &renderer, void *area)
+{
+    static_cast<Area*>(area)->Draw(renderer);
+}
+static void drawParticles([[maybe_unused]] SpriteRenderer &renderer, void *particles)
+{
+    static_cast<ParticleSystem*>(particles)->Draw();
+}
+static void drawGpuParticles([[maybe_unused]] SpriteRenderer &renderer, void *particles)
+{
+    static_cast<GpuParticleSystem*>(particles)->Draw();
+}
+
 void Game::Render()
 {
+    GLState::BeginFrame();
+    FrameUniforms::Update(Camera::Instance->GetViewMatrix(), static_cast<float>(glfwGetTime()));
+    TextureLoader::Update(Prefetcher.Urgent() ? URGENT_UPLOAD_BUDGET_MS : TEXTURE_UPLOAD_BUDGET_MS);
+    TextureResidency::Update();
     Gui::Start();
 
     // Calculate FPS
@@ -148,17 +205,25 @@ void Game::Render()
         lastTime = currentTime;
     }
     if (battleSystem && battleSystem->IsActive()) {
-        battleSystem->Render(*Renderer);
+        battleSystem->Render(Queue);
+        Renderer->Begin();
+        Queue.Execute(*Renderer);
+        Renderer->End();
         battleSystem->RenderUI();
     } else {    
         if(currentArea){
-            currentArea->Draw(*Renderer); 
+            Queue.SubmitCustom(RenderQueue::LAYER_BACKGROUND, 0.0f, 0, 0, drawArea, currentArea.get());
         }
         // Render based on the current game state
         //if ((State == GAME_PAUSED || State == GAME_ACTIVE) && currentArea) {
-            player->Draw(*Renderer);
-            Particles->Draw();
+            player->Submit(Queue);
+            Queue.SubmitCustom(RenderQueue::LAYER_EFFECTS, 0.0f, 0, 0, drawParticles, Particles.get());
+            if (gpuParticles && GpuParticles)
+                Queue.SubmitCustom(RenderQueue::LAYER_EFFECTS, 0.0f, 0, 0, drawGpuParticles, GpuParticles.get());
         //} 
+        Renderer->Begin();
+        Queue.Execute(*Renderer);
+        Renderer->End();
     }
     if(State != GAME_ACTIVE) {
         // Define the size of the window
@@ -253,6 +318,43 @@ void Game::Render()
         ImGui::SetCursorPos(ImVec2(10, 10));
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.0f, 1.0f));
         ImGui::Text("FPS: %.1f", fps);
+        ImGui::Text("Sprite batches: %u", Renderer->DrawCalls());
+        ImGui::Text("Queued items: %zu", Queue.LastSize());
+        if (Particles)
+            ImGui::Text("Particles: %u in %u emitters", Particles->Alive(), Particles->Emitters());
+        ImGui::Text("Pending textures: %zu", TextureLoader::Pending());
+        ImGui::Text("Texture memory: %.1f / %.1f MB (%u evicted, %u reloaded)",
+                    TextureResidency::ResidentBytes() / (1024.0 * 1024.0), TextureResidency::Budget / (1024.0 * 1024.0),
+                    TextureResidency::Evictions(), TextureResidency::Reloads());
+        ImGui::Text("GL state calls: %u issued, %u skipped", GLState::LastFrame.Issued, GLState::LastFrame.Skipped);
+        if (currentArea && currentArea->tilemapManager) {
+            std::shared_ptr<TilemapManager> tilemap = currentArea->tilemapManager;
+            ImGui::Text("Visible chunks: %u", tilemap->VisibleChunks());
+            bool indexTexture = tilemap->GetRenderMode() == TilemapManager::RenderMode::IndexTexture;
+            if (ImGui::Checkbox("Tile index texture", &indexTexture)) {
+                if (indexTexture)
+                    tilemap->EnableIndexTexture(ResourceManager::GetShader("tilemap"));
+                else
+                    tilemap->SetRenderMode(TilemapManager::RenderMode::Mesh);
+            }
+        }
+        if (ImGui::Checkbox("GPU particles", &gpuParticles) && gpuParticles && !GpuParticles) {
+            GpuParticles = std::make_unique<GpuParticleSystem>(
+                ResourceManager::GetShader("particle_update"),
+                ResourceManager::GetShader("particle_gpu"),
+                ResourceManager::GetTexture2D("particle"),
+                GPU_PARTICLE_COUNT
+            );
+            // slow motes drifting over the whole screen
+            GpuParticleEmitter &emitter = GpuParticles->Emitter;
+            emitter.Velocity = glm::vec2(10.0f, -25.0f);
+            emitter.VelocityJitter = glm::vec2(40.0f, 20.0f);
+            emitter.Lifetime = 4.0f;
+            emitter.Fade = 0.2f;
+            emitter.RespawnRate = 0.5f;
+            emitter.Color = glm::vec3(0.6f, 0.7f, 1.0f);
+            emitter.Size = 4.0f;
+        }
         ImGui::PopStyleColor();
         ImGui::End();
     }
@@ -310,11 +412,14 @@ void Game::ProcessInput([[maybe_unused]] float dt)
 
             float distanceMoved = 0.1f;
             stepCounter += distanceMoved;
+            // get the possible enemies resident before the roll can pick one
+            Prefetcher.Update(stepCounter / STEP_THRESHOLD);
 
             if (stepCounter >= STEP_THRESHOLD) {
                 if (debug) std::cout << "Step threshold reached (" << STEP_THRESHOLD << ")" << std::endl;
                 
                 stepCounter = 0.0f;
+                Prefetcher.Update(0.0f);
                 std::uniform_real_distribution<float> battleChance(0.0f, 1.0f);
                 float roll = battleChance(gen);
 
@@ -385,7 +490,12 @@ void Game::Update(float dt)
         currentArea->Update(dt);
         
         if (Particles) {
-            Particles->Update(dt, *player, 4, glm::vec2(60.0f, 135.0f));
+            Particles->Update(dt);
+        }
+        if (gpuParticles && GpuParticles) {
+            GpuParticles->Emitter.Origin = player->Position;
+            GpuParticles->Emitter.Spread = glm::vec2(Width, Height);
+            GpuParticles->Update(dt);
         }
 
         // Check if player has moved
@@ -449,6 +559,7 @@ void Game::ResetPlayer()
         ResourceManager::GetTexture2D("player.png"), 
         glm::vec3(1.0f, 1.0f, 1.0f), 5, 5
     );
+    if (Particles) Particles->Attach(trailEmitter, player.get());
     
     player->tile = 23;
     player->form = 0;
@@ -462,6 +573,20 @@ void Game::ResetPlayer()
         std::cout << "=== Player Reset Complete ===\n" << std::endl;
     }
 }
+// The atlas page holding a texture, or the texture itself if it wasn't packed
+static const Texture2D &spriteTexture(const std::string &texture)
+{
+    if (const AtlasRegion *region = ResourceManager::GetAtlasRegion(texture))
+        return *region->Page;
+    return ResourceManager::GetTexture2D(texture);
+}
+// Points an object at its atlas region when the texture was packed
+static void useAtlasSprite(GameObject &object, const std::string &texture)
+{
+    if (const AtlasRegion *region = ResourceManager::GetAtlasRegion(texture))
+        object.SetSprite(*region);
+}
+
 void Game::ResetLevel()
 {
     if (debug) std::cout << "\n=== Resetting Level ===" << std::endl;
@@ -473,8 +598,9 @@ void Game::ResetLevel()
     auto froggy = std::make_shared<GameObject>(
         glm::vec2(0.0f, 0.0f),
         glm::vec2(200.0f, 400.0f),
-        ResourceManager::GetTexture2D("frog.png")
+        spriteTexture("frog.png")
     );
+    useAtlasSprite(*froggy, "frog.png");
     froggy->name = "Froggy";
     froggy->stats = {150, 80, 70, 50, 50, "Water", "Froggy"};
     monsters.push_back(froggy);
@@ -483,8 +609,9 @@ void Game::ResetLevel()
     auto tortoise = std::make_shared<GameObject>(
         glm::vec2(0.0f, 0.0f),
         glm::vec2(200.0f, 400.0f),
-        ResourceManager::GetTexture2D("turtle.png")
+        spriteTexture("turtle.png")
     );
+    useAtlasSprite(*tortoise, "turtle.png");
     tortoise->name = "Tortoise";
     tortoise->stats = {180, 80, 75, 95, 30, "Water", "Tortoise"};
     monsters.push_back(tortoise);
@@ -493,8 +620,9 @@ void Game::ResetLevel()
     auto scorpio = std::make_shared<GameObject>(
         glm::vec2(0.0f, 0.0f),
         glm::vec2(200.0f, 400.0f),
-        ResourceManager::GetTexture2D("scorpion.png")
+        spriteTexture("scorpion.png")
     );
+    useAtlasSprite(*scorpio, "scorpion.png");
     scorpio->name = "Scorpio";
     scorpio->stats = {120, 120, 65, 55, 50, "Ground", "Scorpio"};
     monsters.push_back(scorpio);
@@ -503,8 +631,9 @@ void Game::ResetLevel()
     auto roawer = std::make_shared<GameObject>(
         glm::vec2(0.0f, 0.0f),
         glm::vec2(200.0f, 400.0f),
-        ResourceManager::GetTexture2D("wolf.png")
+        spriteTexture("wolf.png")
     );
+    useAtlasSprite(*roawer, "wolf.png");
     roawer->name = "Roawer";
     roawer->stats = {150, 150, 80, 60, 60, "Ground", "Roawer"};
     monsters.push_back(roawer);
@@ -513,8 +642,9 @@ void Game::ResetLevel()
     auto insectus = std::make_shared<GameObject>(
         glm::vec2(0.0f, 0.0f),
         glm::vec2(200.0f, 400.0f),
-        ResourceManager::GetTexture2D("insect.png")
+        spriteTexture("insect.png")
     );
+    useAtlasSprite(*insectus, "insect.png");
     insectus->name = "Insectus";
     insectus->stats = {90, 90, 50, 35, 40, "Insect", "Insectus"};
     monsters.push_back(insectus);
@@ -10,15 +10,18 @@
 
 // Include required headers
 #include "../ui/DialogueSystem.h"
-#include "../effects/Particle.h"
+#include "../effects/ParticleSystem.h"
 #include "../render/SpriteRenderer.h"
+#include "../render/RenderQueue.h"
 #include "GameObject.h"
 #include "Player.h"
+#include "EncounterPrefetcher.h"
 
 // Forward declarations for pointers only
 class Area;
 class Battle;
 class Collider;
+class GpuParticleSystem;
 
 /**
  * @brief Main game class that handles game states, rendering, and updates
@@ -127,9 +130,15 @@ protected:
 
     // Core systems
     std::unique_ptr<SpriteRenderer> Renderer;
-    std::unique_ptr<ParticleGenerator> Particles;
+    RenderQueue Queue;
+    std::unique_ptr<ParticleSystem> Particles;
+    ParticleSystem::EmitterId trailEmitter = 0;
+    // Ambient GPU-simulated particles, created when turned on in the overlay
+    std::unique_ptr<GpuParticleSystem> GpuParticles;
+    bool gpuParticles = false;
     std::unique_ptr<Collider> Collision;
     std::shared_ptr<DialogueSystem> Dialogue;
+    EncounterPrefetcher Prefetcher;
 
     // Performance monitoring
     double lastTime;
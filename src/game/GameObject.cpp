@@ -9,5 +9,17 @@ GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec
 
 void GameObject::Draw(SpriteRenderer &renderer)
 {
-    renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), glm::mat4(1.0f), this->Mirror);
+    renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color, this->TextureOffset, this->TextureSize, glm::mat4(1.0f), this->Mirror);
+}
+
+void GameObject::SetSprite(const AtlasRegion &region)
+{
+    this->Sprite = *region.Page;
+    this->TextureOffset = region.TextureOffset;
+    this->TextureSize = region.TextureSize;
+}
+
+void GameObject::Submit(RenderQueue &queue, unsigned int layer)
+{
+    queue.SubmitSprite(layer, this->Position.y + this->Size.y, this->Sprite, this->Position, this->Size, this->Rotation, this->Color, this->TextureOffset, this->TextureSize, this->Mirror);
 }
@@ -8,6 +8,7 @@
 #include <memory>
 #include "Move.h"
 #include "render/SpriteRenderer.h"
+#include "render/RenderQueue.h"
 
 enum class BattleState {
     START,
@@ -43,6 +44,7 @@ public:
 
     // render state
     Texture2D   Sprite;	
+    glm::vec2   TextureOffset = glm::vec2(0.0f), TextureSize = glm::vec2(1.0f);
 
     bool        IsSolid;
     bool        Destroyed;
@@ -65,8 +67,12 @@ public:
     // constructor(s)
     GameObject();
     GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+    // use a region of an atlas page as the sprite
+    void SetSprite(const AtlasRegion &region);
     // draw sprite
     virtual void Draw(SpriteRenderer &renderer);
+    // queue the sprite for this frame, sorted by its bottom edge within the layer
+    virtual void Submit(RenderQueue &queue, unsigned int layer = RenderQueue::LAYER_ENTITIES);
 };
 
 #endif
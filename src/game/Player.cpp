@@ -111,3 +111,7 @@ void Player::Draw(SpriteRenderer& renderer) {
     sheet->DrawPlayer(renderer, this->Position, this->Size, tile);
 }
 
+void Player::Submit(RenderQueue& queue, unsigned int layer) {
+    sheet->SubmitPlayer(queue, layer, this->Position.y + this->Size.y, this->Position, tile);
+}
+
@@ -24,6 +24,7 @@ public:
     void Stop();
     void Update(float dt);
     void Draw(SpriteRenderer& renderer) override;
+    void Submit(RenderQueue& queue, unsigned int layer = RenderQueue::LAYER_ENTITIES) override;
 
     // Animation
     void UpdateAnimation(float dt);
@@ -1,6 +1,9 @@
 #include "init.h"
 #include "types.h"
 #include "game/Game.h"
+#include "render/GLState.h"
+#include "render/FrameUniforms.h"
+#include "asset/TextureLoader.h"
 
 // Define the dimensions
 const unsigned SCREEN_WIDTH = WIDTH;
@@ -86,6 +89,8 @@ int main(int argc, char *argv[])
         root = argv[2];
     }
     ResourceManager::root = root;
+    // optional; see ResourceManager::LooseFirst for which copy wins
+    ResourceManager::OpenPack(root + "assets.pak");
     
     o.setDir(root);
     o << root << " / " << __FILE__ << "\n";
@@ -142,7 +147,7 @@ int main(int argc, char *argv[])
     // OpenGL configuration
     // --------------------
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     Gui::Init(window);
 
     // deltaTime variables
@@ -178,7 +183,9 @@ int main(int argc, char *argv[])
 
     // Clean up
     delete NeuroMonsters;
+    TextureLoader::Shutdown();
     ResourceManager::Clear();
+    FrameUniforms::Destroy();
     Gui::Clean();
     glfwTerminate();
     return 0;
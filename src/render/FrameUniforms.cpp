@@ -0,0 +1,51 @@
+#include "FrameUniforms.h"
+#include "util/Util.h"
+
+static_assert(sizeof(FrameUniforms::Data) == 144, "FrameData must match the std140 layout");
+
+GLuint FrameUniforms::buffer = 0;
+FrameUniforms::Data FrameUniforms::data = { glm::mat4(1.0f), glm::mat4(1.0f), glm::vec2(0.0f), 0.0f, 0.0f };
+
+void FrameUniforms::Init()
+{
+    if (buffer != 0)
+        return;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), &data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer);
+    glCheckError(__FILE__, __LINE__);
+}
+
+void FrameUniforms::Destroy()
+{
+    if (buffer == 0)
+        return;
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+void FrameUniforms::BindBlock(GLuint program)
+{
+    GLuint index = glGetUniformBlockIndex(program, BLOCK_NAME);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, BINDING);
+}
+
+void FrameUniforms::SetProjection(const glm::mat4 &projection, glm::vec2 viewportSize)
+{
+    data.Projection = projection;
+    data.ViewportSize = viewportSize;
+}
+
+void FrameUniforms::Update(const glm::mat4 &view, float time)
+{
+    data.View = view;
+    data.Time = time;
+    if (buffer == 0)
+        return;
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Data), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,51 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Per-frame data shared by every shader through one std140 uniform block:
+//
+//     layout (std140) uniform FrameData {
+//         mat4  projection;
+//         mat4  view;
+//         vec2  viewportSize;
+//         float time;
+//     };
+//
+// Shader::Compile attaches any program declaring the block to BINDING, so
+// the matrices are uploaded once per frame instead of once per draw.
+class FrameUniforms
+{
+public:
+    static const GLuint BINDING = 0;
+    static constexpr const char *BLOCK_NAME = "FrameData";
+
+    // CPU copy of the block, laid out as std140
+    struct Data
+    {
+        glm::mat4 Projection;
+        glm::mat4 View;
+        glm::vec2 ViewportSize;
+        float     Time;
+        float     padding;
+    };
+
+    // creates the buffer and binds it to BINDING; needs a GL context
+    static void Init();
+    static void Destroy();
+    // points a program's FrameData block, if it has one, at BINDING
+    static void BindBlock(GLuint program);
+
+    static void SetProjection(const glm::mat4 &projection, glm::vec2 viewportSize);
+    // uploads the block with this frame's view and time
+    static void Update(const glm::mat4 &view, float time);
+
+private:
+    FrameUniforms() { }
+
+    static GLuint buffer;
+    static Data   data;
+};
+
+#endif
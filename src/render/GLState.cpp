@@ -0,0 +1,148 @@
+#include "GLState.h"
+
+// sentinel for "unknown", never a valid GL name or enum we bind
+static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+GLState::Counters GLState::Frame;
+GLState::Counters GLState::LastFrame;
+
+bool   GLState::valid = false;
+GLuint GLState::program = UNKNOWN;
+GLuint GLState::vertexArray = UNKNOWN;
+GLuint GLState::activeUnit = UNKNOWN;
+GLuint GLState::textures[GLState::MAX_TEXTURE_UNITS];
+GLenum GLState::blendSrc = UNKNOWN, GLState::blendDst = UNKNOWN;
+GLuint GLState::readFramebuffer = UNKNOWN, GLState::drawFramebuffer = UNKNOWN;
+
+void GLState::UseProgram(GLuint program)
+{
+    if (!valid)
+        Invalidate();
+    if (GLState::program == program) {
+        Frame.Skipped++;
+        return;
+    }
+    glUseProgram(program);
+    GLState::program = program;
+    Frame.Issued++;
+}
+
+void GLState::BindVertexArray(GLuint vertexArray)
+{
+    if (!valid)
+        Invalidate();
+    if (GLState::vertexArray == vertexArray) {
+        Frame.Skipped++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    GLState::vertexArray = vertexArray;
+    Frame.Issued++;
+}
+
+void GLState::BindTexture(GLenum target, GLuint texture, GLuint unit)
+{
+    if (!valid)
+        Invalidate();
+    // only 2D bindings are shadowed; other targets still get the right unit
+    if (target != GL_TEXTURE_2D || unit >= MAX_TEXTURE_UNITS) {
+        activate(unit);
+        glBindTexture(target, texture);
+        Frame.Issued++;
+        return;
+    }
+    if (textures[unit] == texture) {
+        Frame.Skipped++;
+        return;
+    }
+    activate(unit);
+    glBindTexture(target, texture);
+    textures[unit] = texture;
+    Frame.Issued++;
+}
+
+void GLState::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    if (!valid)
+        Invalidate();
+    if (blendSrc == sfactor && blendDst == dfactor) {
+        Frame.Skipped++;
+        return;
+    }
+    glBlendFunc(sfactor, dfactor);
+    blendSrc = sfactor;
+    blendDst = dfactor;
+    Frame.Issued++;
+}
+
+void GLState::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    if (!valid)
+        Invalidate();
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    if ((!read || readFramebuffer == framebuffer) && (!draw || drawFramebuffer == framebuffer)) {
+        Frame.Skipped++;
+        return;
+    }
+    glBindFramebuffer(target, framebuffer);
+    if (read)
+        readFramebuffer = framebuffer;
+    if (draw)
+        drawFramebuffer = framebuffer;
+    Frame.Issued++;
+}
+
+void GLState::ForgetProgram(GLuint program)
+{
+    if (GLState::program == program)
+        GLState::program = UNKNOWN;
+}
+
+void GLState::ForgetVertexArray(GLuint vertexArray)
+{
+    if (GLState::vertexArray == vertexArray)
+        GLState::vertexArray = UNKNOWN;
+}
+
+void GLState::ForgetTexture(GLuint texture)
+{
+    for (GLuint &bound : textures)
+        if (bound == texture)
+            bound = UNKNOWN;
+}
+
+void GLState::ForgetFramebuffer(GLuint framebuffer)
+{
+    if (readFramebuffer == framebuffer)
+        readFramebuffer = UNKNOWN;
+    if (drawFramebuffer == framebuffer)
+        drawFramebuffer = UNKNOWN;
+}
+
+void GLState::Invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (GLuint &bound : textures)
+        bound = UNKNOWN;
+    blendSrc = blendDst = UNKNOWN;
+    readFramebuffer = drawFramebuffer = UNKNOWN;
+    valid = true;
+}
+
+void GLState::BeginFrame()
+{
+    LastFrame = Frame;
+    Frame = Counters();
+}
+
+void GLState::activate(GLuint unit)
+{
+    if (activeUnit == unit)
+        return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit = unit;
+    Frame.Issued++;
+}
@@ -0,0 +1,58 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Shadows the GL bindings the renderers touch every frame (program, VAO,
+// per-unit 2D textures, blend function and framebuffers) and drops calls
+// that wouldn't change anything. All binds of these objects should go
+// through here, otherwise the shadow copy goes stale; code that changes
+// them behind our back must call Invalidate() afterwards.
+class GLState
+{
+public:
+    // number of texture units we shadow
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+    // calls issued to the driver versus calls skipped as redundant
+    struct Counters
+    {
+        unsigned int Issued = 0;
+        unsigned int Skipped = 0;
+    };
+    // counters of the frame in progress and of the last completed frame
+    static Counters Frame;
+    static Counters LastFrame;
+
+    static void UseProgram(GLuint program);
+    static void BindVertexArray(GLuint vertexArray);
+    static void BindTexture(GLenum target, GLuint texture, GLuint unit = 0);
+    static void BlendFunc(GLenum sfactor, GLenum dfactor);
+    static void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+    // deleting a bound object resets its binding to 0; keep the shadow in sync
+    static void ForgetProgram(GLuint program);
+    static void ForgetVertexArray(GLuint vertexArray);
+    static void ForgetTexture(GLuint texture);
+    static void ForgetFramebuffer(GLuint framebuffer);
+
+    // forgets everything so the next call of each kind is issued
+    static void Invalidate();
+    // publishes the counters of the previous frame and starts new ones
+    static void BeginFrame();
+
+private:
+    GLState() { }
+
+    static bool   valid;
+    static GLuint program;
+    static GLuint vertexArray;
+    static GLuint activeUnit;
+    static GLuint textures[MAX_TEXTURE_UNITS];
+    static GLenum blendSrc, blendDst;
+    static GLuint readFramebuffer, drawFramebuffer;
+
+    static void activate(GLuint unit);
+};
+
+#endif
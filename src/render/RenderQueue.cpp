@@ -0,0 +1,97 @@
+#include "RenderQueue.h"
+#include <cstring>
+#include <utility>
+
+uint64_t RenderQueue::MakeKey(unsigned int layer, unsigned int shader, unsigned int texture, float depth)
+{
+    // flip the float's bits so unsigned integer order matches numeric order
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+
+    if (layer == LAYER_ENTITIES)
+        return (static_cast<uint64_t>(layer & 0xFFu) << 56)
+             | (static_cast<uint64_t>(bits >> 8) << 32)
+             | (static_cast<uint64_t>(shader & 0xFFFFu) << 16)
+             | static_cast<uint64_t>(texture & 0xFFFFu);
+    return (static_cast<uint64_t>(layer & 0xFFu) << 56)
+         | (static_cast<uint64_t>(shader & 0xFFFFu) << 40)
+         | (static_cast<uint64_t>(texture & 0xFFFFu) << 24)
+         | static_cast<uint64_t>(bits >> 8);
+}
+
+void RenderQueue::SubmitSprite(unsigned int layer, float depth, const Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize, bool mirror)
+{
+    // shader 0 stands for the renderer's own batch shader
+    this->entries.push_back({ MakeKey(layer, 0, texture.ID, depth), static_cast<uint32_t>(this->items.size()) });
+    this->items.push_back({ &texture, position, size, textureOffset, textureSize, color, rotate, mirror, nullptr, nullptr });
+}
+
+void RenderQueue::SubmitCustom(unsigned int layer, float depth, unsigned int shader, unsigned int texture, Callback callback, void *data)
+{
+    this->entries.push_back({ MakeKey(layer, shader, texture, depth), static_cast<uint32_t>(this->items.size()) });
+    Item item = {};
+    item.callback = callback;
+    item.data = data;
+    this->items.push_back(item);
+}
+
+void RenderQueue::Execute(SpriteRenderer &renderer)
+{
+    this->sort();
+    for (const SortEntry &entry : this->entries) {
+        const Item &item = this->items[entry.Index];
+        if (item.callback) {
+            // keep everything sorted before this item ahead of it
+            renderer.Flush();
+            item.callback(renderer, item.data);
+            continue;
+        }
+        // consecutive sprites with the same texture join the same batch
+        renderer.DrawSprite(*item.texture, item.Position, item.Size, item.Rotate, item.Color,
+                            item.TextureOffset, item.TextureSize, glm::mat4(1.0f), item.Mirror);
+    }
+    this->lastSize = this->items.size();
+    this->Clear();
+}
+
+void RenderQueue::Clear()
+{
+    // clear() keeps the capacity for the next frame
+    this->items.clear();
+    this->entries.clear();
+}
+
+void RenderQueue::sort()
+{
+    size_t count = this->entries.size();
+    if (count < 2)
+        return;
+    if (this->scratch.size() < count)
+        this->scratch.resize(this->entries.capacity());
+
+    SortEntry *src = this->entries.data();
+    SortEntry *dst = this->scratch.data();
+    bool swapped = false;
+    for (unsigned int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; ++i)
+            histogram[(src[i].Key >> shift) & 0xFF]++;
+        // every key has the same byte here (e.g. one layer, or equal depth), nothing to do
+        if (histogram[(src[0].Key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t &bucket : histogram) {
+            size_t n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; ++i)
+            dst[histogram[(src[i].Key >> shift) & 0xFF]++] = src[i];
+        std::swap(src, dst);
+        swapped = !swapped;
+    }
+    if (swapped)
+        std::memcpy(this->entries.data(), src, count * sizeof(SortEntry));
+}
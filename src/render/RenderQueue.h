@@ -0,0 +1,91 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "SpriteRenderer.h"
+
+// Collects everything drawn in a frame, tagged with a 64-bit sort key, and
+// draws it in key order. Keys put the layer first, then the shader and the
+// texture, then depth, so items that share GL state end up next to each
+// other and the sprite batch merges them into a single draw. The entity
+// layer has to overlap correctly, so there depth comes before GL state and
+// only neighbours at the same depth share a batch.
+//
+// Key layout:          [63..56 layer][55..40 shader][39..24 texture][23..0 depth]
+// LAYER_ENTITIES:      [63..56 layer][55..32 depth][31..16 shader][15..0 texture]
+class RenderQueue
+{
+public:
+    // Coarse draw order; lower layers are drawn first
+    enum Layer : unsigned int {
+        LAYER_BACKGROUND = 0,
+        LAYER_WORLD      = 1,
+        LAYER_ENTITIES   = 2,
+        LAYER_EFFECTS    = 3,
+        LAYER_OVERLAY    = 4
+    };
+
+    // Draws something the sprite batch can't express; called with the
+    // batch already flushed
+    typedef void (*Callback)(SpriteRenderer &renderer, void *data);
+
+    static uint64_t MakeKey(unsigned int layer, unsigned int shader, unsigned int texture, float depth);
+
+    // Queues a sprite drawn through the renderer's batch; the texture is
+    // referenced, not copied, and must outlive Execute()
+    void SubmitSprite(unsigned int layer,
+                      float depth,
+                      const Texture2D &texture,
+                      glm::vec2 position,
+                      glm::vec2 size,
+                      float rotate = 0.0f,
+                      glm::vec3 color = glm::vec3(1.0f),
+                      glm::vec2 textureOffset = glm::vec2(0.0f, 0.0f),
+                      glm::vec2 textureSize = glm::vec2(1.0f, 1.0f),
+                      bool mirror = false);
+    // Queues a callback; shader and texture only feed the sort key. data
+    // must stay valid until Execute()
+    void SubmitCustom(unsigned int layer, float depth, unsigned int shader, unsigned int texture,
+                      Callback callback, void *data);
+
+    // Sorts the queued items, draws them and empties the queue. Sprites go
+    // through renderer.DrawSprite, so wrap this in renderer.Begin()/End()
+    // to get batching
+    void Execute(SpriteRenderer &renderer);
+    void Clear();
+    size_t Size() const { return items.size(); }
+    // Items drawn by the last Execute()
+    size_t LastSize() const { return lastSize; }
+
+private:
+    struct Item
+    {
+        // sprite data, unused by custom items
+        const Texture2D *texture;
+        glm::vec2    Position, Size, TextureOffset, TextureSize;
+        glm::vec3    Color;
+        float        Rotate;
+        bool         Mirror;
+        // custom items only
+        Callback     callback;
+        void        *data;
+    };
+    struct SortEntry
+    {
+        uint64_t Key;
+        uint32_t Index;
+    };
+
+    // Storage is kept between frames, so steady-state frames don't allocate
+    std::vector<Item>      items;
+    std::vector<SortEntry> entries, scratch;
+    size_t                 lastSize = 0;
+
+    // LSD radix sort of entries by key, 8 bits per pass
+    void sort();
+};
+
+#endif
@@ -1,115 +1,251 @@
 #include "Shader.h"
 #include "util/Util.h"
+#include "GLState.h"
+#include "FrameUniforms.h"
 #include <iostream>
+#include <utility>
+#include <vector>
 
 Shader &Shader::Use()
 {
-    glUseProgram(this->ID);
+    GLState::UseProgram(this->ID);
     return *this;
 }
 
 void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
+{
+    this->Submit(vertexSource, fragmentSource, geometrySource);
+    this->Finish();
+}
+
+void Shader::Submit(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
 {
     unsigned int sVertex, sFragment, gShader;
     // vertex Shader
     sVertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(sVertex, 1, &vertexSource, NULL);
     glCompileShader(sVertex);
-    checkCompileErrors(sVertex, "VERTEX");
     // fragment Shader
     sFragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(sFragment, 1, &fragmentSource, NULL);
     glCompileShader(sFragment);
-    checkCompileErrors(sFragment, "FRAGMENT");
+    this->stages = { sVertex, sFragment };
     // if geometry shader source code is given, also compile geometry shader
     if (geometrySource != nullptr)
     {
         gShader = glCreateShader(GL_GEOMETRY_SHADER);
         glShaderSource(gShader, 1, &geometrySource, NULL);
         glCompileShader(gShader);
-        checkCompileErrors(gShader, "GEOMETRY");
+        this->stages.push_back(gShader);
     }
     // shader program
     this->ID = glCreateProgram();
-    glAttachShader(this->ID, sVertex);
-    glAttachShader(this->ID, sFragment);
-    if (geometrySource != nullptr)
-        glAttachShader(this->ID, gShader);
+    for (unsigned int stage : this->stages)
+        glAttachShader(this->ID, stage);
+    // lets ShaderCache read the binary back after linking; glad only loads
+    // this entry point for GL 4.1+ contexts
+    if (glProgramParameteri)
+        glProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(this->ID);
-    checkCompileErrors(this->ID, "PROGRAM");
+}
+
+bool Shader::Finish()
+{
+    static const char *types[] = { "VERTEX", "FRAGMENT", "GEOMETRY" };
+    for (size_t i = 0; i < this->stages.size(); ++i)
+        checkCompileErrors(this->stages[i], types[i]);
+    bool linked = checkCompileErrors(this->ID, "PROGRAM");
     // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(sVertex);
-    glDeleteShader(sFragment);
-    if (geometrySource != nullptr)
-        glDeleteShader(gShader);
+    for (unsigned int stage : this->stages)
+        glDeleteShader(stage);
+    this->stages.clear();
+    this->prepare();
+    return linked;
+}
+
+bool Shader::CompileFeedback(const char *vertexSource, const std::vector<const char *> &varyings)
+{
+    unsigned int sVertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(sVertex, 1, &vertexSource, NULL);
+    glCompileShader(sVertex);
+    this->stages = { sVertex };
+    this->ID = glCreateProgram();
+    glAttachShader(this->ID, sVertex);
+    // the captured outputs have to be named before linking
+    glTransformFeedbackVaryings(this->ID, static_cast<GLsizei>(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(this->ID);
+    return this->Finish();
+}
+
+bool Shader::LoadBinary(GLenum format, const void *binary, GLsizei length)
+{
+    if (!glProgramBinary)
+        return false;
+    this->ID = glCreateProgram();
+    glProgramBinary(this->ID, format, binary, length);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(this->ID, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        // stale binary (driver update, different GPU); the caller compiles from source
+        glDeleteProgram(this->ID);
+        this->ID = 0;
+        return false;
+    }
+    this->prepare();
+    return true;
+}
+
+void Shader::prepare()
+{
+    FrameUniforms::BindBlock(this->ID);
+    this->reflectUniforms();
 }
 
 void Shader::SetFloat(const char *name, float value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
+    glUniform1f(this->GetUniformLocation(name), value);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetInteger(const char *name, int value, bool useShader)
 {
     if (useShader)
         this->Use ();
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
+    glUniform1i(this->GetUniformLocation(name), value);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetVector2f(const char *name, float x, float y, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+    glUniform2f(this->GetUniformLocation(name), x, y);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetVector2f(const char *name, const glm::vec2 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+    glUniform2f(this->GetUniformLocation(name), value.x, value.y);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetVector3f(const char *name, float x, float y, float z, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+    glUniform3f(this->GetUniformLocation(name), x, y, z);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetVector3f(const char *name, const glm::vec3 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+    glUniform3f(this->GetUniformLocation(name), value.x, value.y, value.z);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetVector4f(const char *name, float x, float y, float z, float w, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+    glUniform4f(this->GetUniformLocation(name), x, y, z, w);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetVector4f(const char *name, const glm::vec4 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+    glUniform4f(this->GetUniformLocation(name), value.x, value.y, value.z, value.w);
     glCheckError(__FILE__, __LINE__);
 }
 void Shader::SetMatrix4(const char *name, const glm::mat4 &matrix, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+    glUniformMatrix4fv(this->GetUniformLocation(name), 1, false, glm::value_ptr(matrix));
     glCheckError(__FILE__, __LINE__);
 }
 
+GLint Shader::GetUniformLocation(const char *name) const
+{
+    const UniformInfo *info = this->findUniform(name);
+    return info ? info->Location : -1;
+}
+const Shader::UniformInfo *Shader::findUniform(const char *name) const
+{
+    if (!this->uniforms)
+        return nullptr;
+    auto it = this->uniforms->find(name);
+    return it != this->uniforms->end() ? &it->second : nullptr;
+}
+void Shader::Set(Uniform<float> uniform, float value)
+{
+    glUniform1f(uniform.Location, value);
+}
+void Shader::Set(Uniform<int> uniform, int value)
+{
+    glUniform1i(uniform.Location, value);
+}
+void Shader::Set(Uniform<glm::vec2> uniform, const glm::vec2 &value)
+{
+    glUniform2f(uniform.Location, value.x, value.y);
+}
+void Shader::Set(Uniform<glm::vec3> uniform, const glm::vec3 &value)
+{
+    glUniform3f(uniform.Location, value.x, value.y, value.z);
+}
+void Shader::Set(Uniform<glm::vec4> uniform, const glm::vec4 &value)
+{
+    glUniform4f(uniform.Location, value.x, value.y, value.z, value.w);
+}
+void Shader::Set(Uniform<glm::mat4> uniform, const glm::mat4 &matrix)
+{
+    glUniformMatrix4fv(uniform.Location, 1, false, glm::value_ptr(matrix));
+}
+
+void Shader::reflectUniforms()
+{
+    auto table = std::make_shared<UniformTable>();
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; ++i)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(this->ID, i, maxLength, &length, &size, &type, buffer.data());
+        GLint location = glGetUniformLocation(this->ID, buffer.data());
+        if (location == -1)
+            continue; // members of uniform blocks have no location
+        std::string name(buffer.data(), length);
+        // arrays are reported as "name[0]"; register them under the plain name too
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            (*table)[name.substr(0, name.size() - 3)] = { location, type };
+        (*table)[name] = { location, type };
+    }
+    // copies made before this keep the table of the program they were copied from
+    this->uniforms = std::move(table);
+    glCheckError(__FILE__, __LINE__);
+}
+void Shader::checkUniformType(const char *name, GLenum expected) const
+{
+    const UniformInfo *info = this->findUniform(name);
+    if (!info)
+    {
+        std::cout << "| WARNING::SHADER: uniform '" << name << "' is not active in program " << this->ID << std::endl;
+        return;
+    }
+    GLenum actual = info->Type;
+    // samplers and bools are set through integer uniforms
+    bool integer = actual == GL_INT || actual == GL_BOOL || actual == GL_SAMPLER_2D || actual == GL_SAMPLER_1D || actual == GL_SAMPLER_3D
+                || actual == GL_UNSIGNED_INT_SAMPLER_2D || actual == GL_INT_SAMPLER_2D;
+    if (actual != expected && !(expected == GL_INT && integer))
+        std::cout << "| WARNING::SHADER: uniform '" << name << "' requested with a mismatching type" << std::endl;
+}
 
-void Shader::checkCompileErrors(unsigned int object, std::string type)
+bool Shader::checkCompileErrors(unsigned int object, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -135,4 +271,5 @@ void Shader::checkCompileErrors(unsigned int object, std::string type)
                 << std::endl;
         }
     }
+    return success;
 }
\ No newline at end of file
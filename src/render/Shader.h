@@ -1,13 +1,25 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 
+// Typed handle to a uniform location. Fetch it once with
+// Shader::GetUniform and pass it to Shader::Set on every draw.
+template <typename T>
+struct Uniform
+{
+    GLint Location = -1;
+    bool  Valid() const { return Location != -1; }
+};
+
 // General purpose shader object. Compiles from file, generates
 // compile/link-time error messages and hosts several utility
 // functions for easy management.
@@ -17,11 +29,23 @@ public:
     // state
     unsigned int ID;
     // constructor
-    Shader() { }
+    Shader() : ID(0) { }
     // sets the current shader as active
     Shader  &Use();
     // compiles the shader from given source code
     void    Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr); // note: geometry source code is optional
+    // two-step compile: Submit starts compiling and linking without asking
+    // for any status, so drivers that compile in the background can work on
+    // several programs at once; Finish waits, reports errors and returns
+    // whether the program linked
+    void    Submit(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr);
+    bool    Finish();
+    // compiles a vertex-only program whose outputs are captured with
+    // transform feedback, interleaved in the order of varyings
+    bool    CompileFeedback(const char *vertexSource, const std::vector<const char *> &varyings);
+    // creates the program from a binary returned by glGetProgramBinary;
+    // false (and no program) if the driver rejects it
+    bool    LoadBinary(GLenum format, const void *binary, GLsizei length);
     // utility functions
     void    SetFloat    (const char *name, float value, bool useShader = false);
     void    SetInteger  (const char *name, int value, bool useShader = false);
@@ -32,9 +56,54 @@ public:
     void    SetVector4f (const char *name, float x, float y, float z, float w, bool useShader = false);
     void    SetVector4f (const char *name, const glm::vec4 &value, bool useShader = false);
     void    SetMatrix4  (const char *name, const glm::mat4 &matrix, bool useShader = false);
+    // uniform lookups, served from the table reflected after linking
+    GLint   GetUniformLocation(const char *name) const;
+    template <typename T>
+    Uniform<T> GetUniform(const char *name) const;
+    // typed setters; the shader must be in use
+    void    Set(Uniform<float> uniform, float value);
+    void    Set(Uniform<int> uniform, int value);
+    void    Set(Uniform<glm::vec2> uniform, const glm::vec2 &value);
+    void    Set(Uniform<glm::vec3> uniform, const glm::vec3 &value);
+    void    Set(Uniform<glm::vec4> uniform, const glm::vec4 &value);
+    void    Set(Uniform<glm::mat4> uniform, const glm::mat4 &matrix);
 private:
+    struct UniformInfo
+    {
+        GLint  Location;
+        GLenum Type;
+    };
+    typedef std::unordered_map<std::string, UniformInfo> UniformTable;
+    // active uniforms by name, filled once by Compile; shared by every copy
+    // of the shader instead of being duplicated with it
+    std::shared_ptr<const UniformTable> uniforms;
+    // the entry for name, or nullptr
+    const UniformInfo *findUniform(const char *name) const;
+    // queries every active uniform of the linked program
+    void    reflectUniforms();
+    // warns when a handle is requested with a type that doesn't match the GLSL declaration
+    void    checkUniformType(const char *name, GLenum expected) const;
+    // stage objects of a submitted program, deleted by Finish
+    std::vector<unsigned int> stages;
+    // binds the FrameData block and reflects the uniforms of the linked program
+    void    prepare();
     // checks if compilation or linking failed and if so, print the error logs
-    void    checkCompileErrors(unsigned int object, std::string type);
+    bool    checkCompileErrors(unsigned int object, std::string type);
 };
 
+template <typename T> struct UniformType;
+template <> struct UniformType<float>     { static constexpr GLenum Value = GL_FLOAT; };
+template <> struct UniformType<int>       { static constexpr GLenum Value = GL_INT; };
+template <> struct UniformType<glm::vec2> { static constexpr GLenum Value = GL_FLOAT_VEC2; };
+template <> struct UniformType<glm::vec3> { static constexpr GLenum Value = GL_FLOAT_VEC3; };
+template <> struct UniformType<glm::vec4> { static constexpr GLenum Value = GL_FLOAT_VEC4; };
+template <> struct UniformType<glm::mat4> { static constexpr GLenum Value = GL_FLOAT_MAT4; };
+
+template <typename T>
+Uniform<T> Shader::GetUniform(const char *name) const
+{
+    checkUniformType(name, UniformType<T>::Value);
+    return Uniform<T>{ GetUniformLocation(name) };
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "ShaderCache.h"
+
+#include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include "asset/ResourceManager.h"
+#include "util/MappedFile.h"
+#include "util/Util.h"
+
+// not part of our glad build; looked up at runtime
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+namespace
+{
+    // file layout: this header, then Length bytes of program binary
+    struct BinaryHeader
+    {
+        char     Magic[4];  // "NMSH"
+        uint32_t Version;
+        uint32_t Format;
+        uint32_t Length;
+    };
+    const uint32_t BINARY_VERSION = 1;
+
+    // one program of a batch on its way through Build
+    struct Pending
+    {
+        size_t   Index;
+        uint64_t Key;
+    };
+}
+
+bool     ShaderCache::Enabled = true;
+bool     ShaderCache::initialized = false;
+bool     ShaderCache::binaries = false;
+bool     ShaderCache::parallel = false;
+uint64_t ShaderCache::deviceHash = 0;
+
+void ShaderCache::init()
+{
+    if (initialized)
+        return;
+    initialized = true;
+
+    // the binary is only valid for the driver that produced it
+    deviceHash = hashBytes(nullptr, 0);
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char *value = reinterpret_cast<const char *>(glGetString(name));
+        if (value)
+            deviceHash = hashBytes(value, std::strlen(value), deviceHash);
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    // a 3.3 context may report formats through ARB_get_program_binary, but
+    // glad only loads the entry points with GL 4.1
+    binaries = formats > 0 && glProgramBinary && glGetProgramBinary && glProgramParameteri;
+
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && !parallel; ++i) {
+        const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (!name)
+            continue;
+        const char *entry = nullptr;
+        if (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+            entry = "glMaxShaderCompilerThreadsKHR";
+        else if (std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)
+            entry = "glMaxShaderCompilerThreadsARB";
+        if (!entry)
+            continue;
+        auto maxThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress(entry));
+        if (maxThreads) {
+            // let the driver pick how many threads to use
+            maxThreads(0xFFFFFFFFu);
+            parallel = true;
+        }
+    }
+    glCheckError(__FILE__, __LINE__);
+}
+
+uint64_t ShaderCache::keyFor(const Source &source)
+{
+    uint64_t key = deviceHash;
+    key = hashBytes(source.Vertex.data(), source.Vertex.size(), key);
+    key = hashBytes("\0", 1, key);
+    key = hashBytes(source.Fragment.data(), source.Fragment.size(), key);
+    if (source.HasGeometry) {
+        key = hashBytes("\0", 1, key);
+        key = hashBytes(source.Geometry.data(), source.Geometry.size(), key);
+    }
+    return key;
+}
+
+std::string ShaderCache::pathFor(uint64_t key)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return ResourceManager::root + "cache/shaders/" + name + ".bin";
+}
+
+bool ShaderCache::loadBinary(uint64_t key, Shader &shader)
+{
+    MappedFile file;
+    if (!file.Open(pathFor(key)) || file.Size() < sizeof(BinaryHeader))
+        return false;
+    BinaryHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.Magic, "NMSH", 4) != 0 || header.Version != BINARY_VERSION
+        || file.Size() < sizeof(BinaryHeader) + header.Length)
+        return false;
+    return shader.LoadBinary(header.Format, file.Data() + sizeof(BinaryHeader), header.Length);
+}
+
+void ShaderCache::storeBinary(uint64_t key, const Shader &shader)
+{
+    GLint length = 0;
+    glGetProgramiv(shader.ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(shader.ID, length, &length, &format, binary.data());
+
+    BinaryHeader header;
+    std::memcpy(header.Magic, "NMSH", 4);
+    header.Version = BINARY_VERSION;
+    header.Format = format;
+    header.Length = static_cast<uint32_t>(length);
+
+    std::string path = pathFor(key);
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(binary.data(), length);
+    if (!out)
+        std::cerr << "Failed to write shader cache: " << path << std::endl;
+}
+
+std::vector<Shader> ShaderCache::Build(const std::vector<Source> &sources)
+{
+    init();
+    bool cached = Enabled && binaries;
+    std::vector<Shader> shaders(sources.size());
+    std::vector<Pending> pending;
+
+    // hits are ready right away; misses only get submitted
+    for (size_t i = 0; i < sources.size(); ++i) {
+        uint64_t key = keyFor(sources[i]);
+        if (cached && loadBinary(key, shaders[i]))
+            continue;
+        const Source &source = sources[i];
+        shaders[i].Submit(source.Vertex.c_str(), source.Fragment.c_str(),
+                          source.HasGeometry ? source.Geometry.c_str() : nullptr);
+        pending.push_back({ i, key });
+    }
+
+    // finish programs as the driver completes them, so the binary reads
+    // overlap the compiles still running; without the extension the first
+    // status query simply blocks until that program is done
+    while (!pending.empty()) {
+        bool progressed = false;
+        for (size_t p = 0; p < pending.size();) {
+            Shader &shader = shaders[pending[p].Index];
+            GLint done = GL_TRUE;
+            if (parallel)
+                glGetProgramiv(shader.ID, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done) {
+                ++p;
+                continue;
+            }
+            if (shader.Finish() && cached)
+                storeBinary(pending[p].Key, shader);
+            pending[p] = pending.back();
+            pending.pop_back();
+            progressed = true;
+        }
+        if (!progressed)
+            std::this_thread::yield();
+    }
+    glCheckError(__FILE__, __LINE__);
+    return shaders;
+}
@@ -0,0 +1,49 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+// Builds shader programs in batches and keeps their linked binaries under
+// <root>/cache/shaders/. A binary is keyed by a hash of the sources and of
+// the GL vendor, renderer and version strings, so a driver update or a
+// different GPU simply misses. Binaries the driver rejects fall back to
+// compiling from source.
+//
+// Cache misses of a batch are all submitted before any status is queried;
+// with GL_KHR_parallel_shader_compile (or the ARB version) the driver
+// compiles them on its own threads.
+class ShaderCache
+{
+public:
+    struct Source
+    {
+        std::string Vertex, Fragment, Geometry;
+        bool        HasGeometry = false;
+    };
+
+    // turns the binary cache off; batches still compile together
+    static bool Enabled;
+
+    // builds one program per source, in order; needs a GL context
+    static std::vector<Shader> Build(const std::vector<Source> &sources);
+
+private:
+    ShaderCache() { }
+
+    static bool     initialized;
+    static bool     binaries;       // driver supports at least one binary format
+    static bool     parallel;       // driver compiles in the background
+    static uint64_t deviceHash;
+
+    static void        init();
+    static uint64_t    keyFor(const Source &source);
+    static std::string pathFor(uint64_t key);
+    static bool        loadBinary(uint64_t key, Shader &shader);
+    static void        storeBinary(uint64_t key, const Shader &shader);
+};
+
+#endif
@@ -1,7 +1,23 @@
 #include "SpriteRenderer.h"
 #include "util/Util.h"
 #include "transform.h"
-#include "game/Camera.h"
+#include "GLState.h"
+#include "asset/TextureResidency.h"
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Unit quad in the same winding as the VBO Game::Init hands the renderer
+static const glm::vec4 unitQuad[6] = {
+    // pos      // tex
+    { 0.0f, 1.0f, 0.0f, 1.0f },
+    { 1.0f, 0.0f, 1.0f, 0.0f },
+    { 0.0f, 0.0f, 0.0f, 0.0f },
+
+    { 0.0f, 1.0f, 0.0f, 1.0f },
+    { 1.0f, 1.0f, 1.0f, 1.0f },
+    { 1.0f, 0.0f, 1.0f, 0.0f }
+};
 
 glm::mat4 mat2To4(const glm::mat2& mat2){
     return glm::mat4(
@@ -13,17 +29,39 @@ glm::mat4 mat2To4(const glm::mat2& mat2){
 }
 
 SpriteRenderer::SpriteRenderer(const Shader &shader, const std::vector<float> &vertices)
+    : quadVAO(0), quadVBO(0), hasBatchShader(false), batching(false), batchVAO(0), batchVBO(0), batchTexture(0), drawCalls(0),
+      hasInstanceShader(false), instanceVAO(0), instanceVBO(0)
 {
     this->shader = shader;
+    this->modelUniform = shader.GetUniform<glm::mat4>("model");
+    this->textureOffsetUniform = shader.GetUniform<glm::vec2>("textureOffset");
+    this->textureSizeUniform = shader.GetUniform<glm::vec2>("textureSize");
+    this->spriteColorUniform = shader.GetUniform<glm::vec3>("spriteColor");
     this->initRenderData(vertices);
+    this->initBatchData();
+    this->initInstanceData();
 }
 
 SpriteRenderer::~SpriteRenderer()
 {
+    GLState::ForgetVertexArray(this->quadVAO);
+    GLState::ForgetVertexArray(this->batchVAO);
+    GLState::ForgetVertexArray(this->instanceVAO);
     if(glIsVertexArray(this->quadVAO) == GL_TRUE) {
         glDeleteVertexArrays(1, &this->quadVAO);
         glCheckError();
     }
+    if(glIsVertexArray(this->batchVAO) == GL_TRUE) {
+        glDeleteVertexArrays(1, &this->batchVAO);
+        glDeleteBuffers(1, &this->batchVBO);
+        glCheckError();
+    }
+    if(glIsVertexArray(this->instanceVAO) == GL_TRUE) {
+        glDeleteVertexArrays(1, &this->instanceVAO);
+        glDeleteBuffers(1, &this->instanceVBO);
+        glCheckError();
+    }
+    glDeleteBuffers(1, &this->quadVBO);
 }
 glm::mat4 SpriteRenderer::Transform(glm::vec2 position, glm::vec2 size, float rotate) {
     glm::mat4 model = glm::mat4(1.0f);
@@ -37,35 +75,69 @@ glm::mat4 SpriteRenderer::Transform(glm::vec2 position, glm::vec2 size, float ro
 
     return model;
 }
+void SpriteRenderer::AppendQuad(std::vector<SpriteVertex>& out, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize, bool mirror)
+{
+    // same order as Transform(): scale, rotate around the quad's centre, translate
+    glm::vec2 half = 0.5f * size;
+    float s = 0.0f, c = 1.0f;
+    if (rotate != 0.0f) {
+        s = std::sin(glm::radians(rotate));
+        c = std::cos(glm::radians(rotate));
+    }
+    for (const glm::vec4 &v : unitQuad) {
+        glm::vec2 local = glm::vec2(mirror ? -v.x : v.x, v.y) * size - half;
+        glm::vec2 world = position + half + glm::vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+        out.push_back({ world, glm::vec2(v.z, v.w) * textureSize + textureOffset, color });
+    }
+}
+SpriteInstance SpriteRenderer::MakeInstance(glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize, bool mirror)
+{
+    glm::vec2 half = 0.5f * size;
+    float s = 0.0f, c = 1.0f;
+    if (rotate != 0.0f) {
+        s = std::sin(glm::radians(rotate));
+        c = std::cos(glm::radians(rotate));
+    }
+    float flip = mirror ? -1.0f : 1.0f;
+
+    SpriteInstance instance;
+    instance.AxisX = glm::vec2(c, s) * (flip * size.x);
+    instance.AxisY = glm::vec2(-s, c) * size.y;
+    instance.Translation = position + half - glm::vec2(c * half.x - s * half.y, s * half.x + c * half.y);
+    instance.TextureOffset = textureOffset;
+    instance.TextureSize = textureSize;
+    glm::uvec3 rgb = glm::uvec3(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+    instance.Color = rgb.r | (rgb.g << 8) | (rgb.b << 16) | (255u << 24);
+    return instance;
+}
 void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::mat4 model, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize, glm::mat4 view)
 {
-    Bind();
+    if (this->batching) {
+        this->Submit(texture, model, color, textureOffset, textureSize);
+        return;
+    }
     // prepare transformations
     this->shader.Use();
-    this->shader.SetMatrix4("model", model);
-    this->shader.SetMatrix4("view", Camera::Instance->GetViewMatrix());
+    this->shader.Set(this->modelUniform, model);
 
-    this->shader.SetVector2f("textureOffset", textureOffset);
-    this->shader.SetVector2f("textureSize", textureSize);    
+    this->shader.Set(this->textureOffsetUniform, textureOffset);
+    this->shader.Set(this->textureSizeUniform, textureSize);
 
     // render textured quad
-    this->shader.SetVector3f("spriteColor", color);
-
-    glActiveTexture(GL_TEXTURE0);
-    glCheckError();
+    this->shader.Set(this->spriteColorUniform, color);
 
     texture.Bind();
 
-    glBindVertexArray(this->quadVAO);
-    glCheckError();
+    Bind();
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glCheckError();
-    glBindVertexArray(0);
-    glCheckError();
 }
 void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize, glm::mat4 view, bool mirror)
 {
-    Bind();
+    if (this->batching) {
+        this->Submit(texture, position, size, rotate, color, textureOffset, textureSize, mirror);
+        return;
+    }
     // prepare transformations
     this->shader.Use();
     glm::mat4 model = SpriteRenderer::Transform(position, size, rotate);
@@ -74,43 +146,186 @@ void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, gl
     if (mirror) {
         model = glm::scale(model, glm::vec3(-1.0f, 1.0f, 1.0f)); // Mirror horizontally
     }
-    this->shader.SetMatrix4("model", model);
-    this->shader.SetMatrix4("view", Camera::Instance->GetViewMatrix());
+    this->shader.Set(this->modelUniform, model);
 
     // render textured quad
-    this->shader.SetVector3f("spriteColor", color);
-    
-    this->shader.SetVector2f("textureOffset", textureOffset);
-    this->shader.SetVector2f("textureSize", textureSize);    
+    this->shader.Set(this->spriteColorUniform, color);
 
-    glActiveTexture(GL_TEXTURE0);
-    glCheckError();
+    this->shader.Set(this->textureOffsetUniform, textureOffset);
+    this->shader.Set(this->textureSizeUniform, textureSize);
 
     texture.Bind();
 
-    glBindVertexArray(this->quadVAO);
-    glCheckError();
-     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glCheckError();
-    glBindVertexArray(0);
+    Bind();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
     glCheckError();
 }
+void SpriteRenderer::SetBatchShader(const Shader &shader)
+{
+    // a different program can't share the pending draw call
+    this->Flush();
+    this->batchShader = shader;
+    this->hasBatchShader = true;
+}
+void SpriteRenderer::SetInstanceShader(const Shader &shader)
+{
+    this->Flush();
+    this->instanceShader = shader;
+    this->hasInstanceShader = true;
+}
+void SpriteRenderer::Begin()
+{
+    this->drawCalls = 0;
+    this->batchVertices.clear();
+    this->batchInstances.clear();
+    this->batching = this->hasBatchShader || this->hasInstanceShader;
+}
+void SpriteRenderer::Submit(const Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize, bool mirror)
+{
+    this->prepareBatch(texture);
+    if (this->hasInstanceShader)
+        this->batchInstances.push_back(SpriteRenderer::MakeInstance(position, size, rotate, color, textureOffset, textureSize, mirror));
+    else
+        SpriteRenderer::AppendQuad(this->batchVertices, position, size, rotate, color, textureOffset, textureSize, mirror);
+}
+void SpriteRenderer::Submit(const Texture2D &texture, const glm::mat4 &model, glm::vec3 color, glm::vec2 textureOffset, glm::vec2 textureSize)
+{
+    this->prepareBatch(texture);
+    if (this->hasInstanceShader) {
+        SpriteInstance instance = SpriteRenderer::MakeInstance(glm::vec2(0.0f), glm::vec2(1.0f), 0.0f, color, textureOffset, textureSize);
+        instance.AxisX = glm::vec2(model[0]);
+        instance.AxisY = glm::vec2(model[1]);
+        instance.Translation = glm::vec2(model[3]);
+        this->batchInstances.push_back(instance);
+        return;
+    }
+    for (const glm::vec4 &v : unitQuad) {
+        glm::vec4 world = model * glm::vec4(v.x, v.y, 0.0f, 1.0f);
+        this->batchVertices.push_back({ glm::vec2(world), glm::vec2(v.z, v.w) * textureSize + textureOffset, color });
+    }
+}
+void SpriteRenderer::prepareBatch(const Texture2D &texture)
+{
+    // the batch binds by name at flush time, so count the use here
+    TextureResidency::Touch(texture.ID);
+    size_t pending = this->hasInstanceShader ? this->batchInstances.size() : this->batchVertices.size() / 6;
+    if (pending == 0) {
+        this->batchTexture = texture.ID;
+        return;
+    }
+    if (this->batchTexture != texture.ID || pending >= MAX_BATCH_SPRITES) {
+        this->Flush();
+        this->batchTexture = texture.ID;
+    }
+}
+void SpriteRenderer::Flush()
+{
+    if (!this->batchInstances.empty()) {
+        GLState::BindTexture(GL_TEXTURE_2D, this->batchTexture);
+        this->drawInstances(this->batchInstances.data(), static_cast<unsigned int>(this->batchInstances.size()));
+        this->batchInstances.clear();
+        this->drawCalls++;
+    }
+    if (this->batchVertices.empty())
+        return;
+
+    this->batchShader.Use();
+
+    GLState::BindTexture(GL_TEXTURE_2D, this->batchTexture);
+
+    GLState::BindVertexArray(this->batchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->batchVBO);
+    // orphan the previous contents so the driver doesn't stall on in-flight draws
+    glBufferData(GL_ARRAY_BUFFER, MAX_BATCH_SPRITES * 6 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->batchVertices.size() * sizeof(SpriteVertex), this->batchVertices.data());
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(this->batchVertices.size()));
+    glCheckError(__FILE__, __LINE__);
+
+    this->batchVertices.clear();
+    this->drawCalls++;
+}
+void SpriteRenderer::DrawInstanced(const Texture2D &texture, const SpriteInstance *instances, unsigned int count)
+{
+    if (!this->hasInstanceShader || count == 0)
+        return;
+    // keep the pending batch ahead of this draw
+    this->Flush();
+    texture.Bind();
+    for (unsigned int first = 0; first < count; first += MAX_BATCH_SPRITES)
+        this->drawInstances(instances + first, std::min(count - first, MAX_BATCH_SPRITES));
+}
+void SpriteRenderer::drawInstances(const SpriteInstance *instances, unsigned int count)
+{
+    this->instanceShader.Use();
+
+    GLState::BindVertexArray(this->instanceVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_BATCH_SPRITES * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(SpriteInstance), instances);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+    glCheckError(__FILE__, __LINE__);
+}
+void SpriteRenderer::EnableVertexLayout()
+{
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, Position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, TexCoords));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, Color));
+}
+void SpriteRenderer::DrawMesh(const Texture2D &texture, unsigned int vao, int first, int count)
+{
+    if (!this->hasBatchShader || count <= 0)
+        return;
+    // keep the pending batch ahead of this draw
+    this->Flush();
+
+    this->batchShader.Use();
+    texture.Bind();
+    GLState::BindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, first, count);
+    glCheckError(__FILE__, __LINE__);
+    this->drawCalls++;
+}
+void SpriteRenderer::DrawMesh(const Texture2D &texture, unsigned int vao, const int *firsts, const int *counts, int ranges)
+{
+    if (!this->hasBatchShader || ranges <= 0)
+        return;
+    this->Flush();
+
+    this->batchShader.Use();
+    texture.Bind();
+    GLState::BindVertexArray(vao);
+    glMultiDrawArrays(GL_TRIANGLES, firsts, counts, ranges);
+    glCheckError(__FILE__, __LINE__);
+    this->drawCalls++;
+}
+void SpriteRenderer::DrawQuad()
+{
+    this->Bind();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glCheckError(__FILE__, __LINE__);
+    this->drawCalls++;
+}
+void SpriteRenderer::End()
+{
+    this->Flush();
+    this->batching = false;
+}
 void SpriteRenderer::Bind() {
-    glBindVertexArray(this->quadVAO);
-    glCheckError();
+    GLState::BindVertexArray(this->quadVAO);
 }
 
 void SpriteRenderer::initRenderData(const std::vector<float> &vertices)
 {
     // configure VAO/VBO
-    unsigned int VBO;
-
     glGenVertexArrays(1, &this->quadVAO);
     glCheckError();
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->quadVBO);
     glCheckError();
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glCheckError();
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
     glCheckError();
@@ -122,6 +337,49 @@ void SpriteRenderer::initRenderData(const std::vector<float> &vertices)
     glCheckError();
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glCheckError();
-    glBindVertexArray(0);
-    glCheckError();
+}
+void SpriteRenderer::initBatchData()
+{
+    this->batchVertices.reserve(MAX_BATCH_SPRITES * 6);
+
+    glGenVertexArrays(1, &this->batchVAO);
+    glGenBuffers(1, &this->batchVBO);
+    GLState::BindVertexArray(this->batchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->batchVBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_BATCH_SPRITES * 6 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+    SpriteRenderer::EnableVertexLayout();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glCheckError(__FILE__, __LINE__);
+}
+void SpriteRenderer::initInstanceData()
+{
+    this->batchInstances.reserve(MAX_BATCH_SPRITES);
+
+    glGenVertexArrays(1, &this->instanceVAO);
+    glGenBuffers(1, &this->instanceVBO);
+    GLState::BindVertexArray(this->instanceVAO);
+    // per-vertex: the shared unit quad
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // per-instance: transform, UV rect and tint
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_BATCH_SPRITES * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+    const size_t offsets[5] = {
+        offsetof(SpriteInstance, AxisX),
+        offsetof(SpriteInstance, AxisY),
+        offsetof(SpriteInstance, Translation),
+        offsetof(SpriteInstance, TextureOffset),
+        offsetof(SpriteInstance, TextureSize)
+    };
+    for (unsigned int i = 0; i < 5; ++i) {
+        glEnableVertexAttribArray(1 + i);
+        glVertexAttribPointer(1 + i, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsets[i]);
+        glVertexAttribDivisor(1 + i, 1);
+    }
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, Color));
+    glVertexAttribDivisor(6, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glCheckError(__FILE__, __LINE__);
 }
\ No newline at end of file
@@ -12,9 +12,33 @@
 // constexpr function to convert glm::mat2 to glm::mat4
 glm::mat4 mat2To4(const glm::mat2& mat2);
 
+// Vertex layout of the batched path: world-space position, final
+// texture coordinates and the sprite's tint
+struct SpriteVertex
+{
+    glm::vec2 Position;
+    glm::vec2 TexCoords;
+    glm::vec3 Color;
+};
+
+// Per-instance data of the instanced path (44 bytes): the sprite's 2D
+// affine transform, its UV rect and a packed RGBA8 tint
+struct SpriteInstance
+{
+    glm::vec2    AxisX;
+    glm::vec2    AxisY;
+    glm::vec2    Translation;
+    glm::vec2    TextureOffset;
+    glm::vec2    TextureSize;
+    unsigned int Color;
+};
+
 class SpriteRenderer
 {
 public:
+    // Maximum number of sprites collected before a batch is flushed
+    static constexpr unsigned int MAX_BATCH_SPRITES = 4096;
+
     // Constructor (inits shaders/shapes)
 
     SpriteRenderer(const Shader &shader, const std::vector<float> &vertices);
@@ -38,14 +62,99 @@ public:
                        glm::vec2 textureSize = glm::vec2(9.0f, 1.0f),
                     glm::mat4 view = glm::mat4(1.0f));
     static glm::mat4 Transform(glm::vec2 position, glm::vec2 size, float rotate);
+    // Appends the two triangles of a sprite, transformed to world space on the CPU
+    static void AppendQuad(std::vector<SpriteVertex>& out,
+                           glm::vec2 position,
+                           glm::vec2 size,
+                           float rotate = 0.0f,
+                           glm::vec3 color = glm::vec3(1.0f),
+                           glm::vec2 textureOffset = glm::vec2(0.0f, 0.0f),
+                           glm::vec2 textureSize = glm::vec2(1.0f, 1.0f),
+                           bool mirror = false);
+
+    // Builds the instance record of a sprite, matching Transform()
+    static SpriteInstance MakeInstance(glm::vec2 position,
+                                       glm::vec2 size,
+                                       float rotate = 0.0f,
+                                       glm::vec3 color = glm::vec3(1.0f),
+                                       glm::vec2 textureOffset = glm::vec2(0.0f, 0.0f),
+                                       glm::vec2 textureSize = glm::vec2(1.0f, 1.0f),
+                                       bool mirror = false);
+
+    // Batching: between Begin() and End() every DrawSprite is routed to
+    // Submit(), which collects quads and issues one draw call per run of
+    // sprites sharing a texture and shader. With an instance shader set the
+    // batch is drawn with glDrawArraysInstanced, otherwise as CPU-expanded
+    // vertices through the batch shader.
+    void SetBatchShader(const Shader &shader);
+    void SetInstanceShader(const Shader &shader);
+    // Draws a prepared set of instances in a single call
+    void DrawInstanced(const Texture2D &texture, const SpriteInstance *instances, unsigned int count);
+    void Begin();
+    void Submit(const Texture2D& texture,
+                glm::vec2 position,
+                glm::vec2 size = glm::vec2(10.0f, 10.0f),
+                float rotate = 0.0f,
+                glm::vec3 color = glm::vec3(1.0f),
+                glm::vec2 textureOffset = glm::vec2(0.0f, 0.0f),
+                glm::vec2 textureSize = glm::vec2(1.0f, 1.0f),
+                bool mirror = false);
+    void Submit(const Texture2D& texture,
+                const glm::mat4& model,
+                glm::vec3 color = glm::vec3(1.0f),
+                glm::vec2 textureOffset = glm::vec2(0.0f, 0.0f),
+                glm::vec2 textureSize = glm::vec2(1.0f, 1.0f));
+    // Draws everything collected so far
+    void Flush();
+    // Flushes and leaves batching mode
+    void End();
+    bool IsBatching() const { return batching; }
+    // Draw calls issued by the batch since the last Begin()
+    unsigned int DrawCalls() const { return drawCalls; }
+
+    // Static meshes: geometry baked once into a caller-owned VAO laid out
+    // as SpriteVertex (see EnableVertexLayout) and drawn with the batch shader
+    static void EnableVertexLayout();
+    bool CanDrawMesh() const { return hasBatchShader; }
+    void DrawMesh(const Texture2D &texture, unsigned int vao, int first, int count);
+    // Draws several ranges of the same mesh with one glMultiDrawArrays
+    void DrawMesh(const Texture2D &texture, unsigned int vao, const int *firsts, const int *counts, int ranges);
+    // Draws the unit quad (vec4 pos/tex at location 0) with whatever program
+    // and textures the caller has bound; call Flush() before binding them
+    void DrawQuad();
 
     void Bind();
 private:
     // Render state
     Shader       shader;
-    unsigned int quadVAO;
+    unsigned int quadVAO, quadVBO;
+    // Uniform handles, fetched once per shader
+    Uniform<glm::mat4> modelUniform;
+    Uniform<glm::vec2> textureOffsetUniform, textureSizeUniform;
+    Uniform<glm::vec3> spriteColorUniform;
+    // Batch state
+    Shader       batchShader;
+    bool         hasBatchShader;
+    bool         batching;
+    unsigned int batchVAO, batchVBO;
+    unsigned int batchTexture;
+    std::vector<SpriteVertex> batchVertices;
+    unsigned int drawCalls;
+    // Instancing state
+    Shader       instanceShader;
+    bool         hasInstanceShader;
+    unsigned int instanceVAO, instanceVBO;
+    std::vector<SpriteInstance> batchInstances;
     // Initializes and configures the quad's buffer and vertex attributes
     void initRenderData(const std::vector<float> &vertices);
+    // Initializes the streaming vertex buffer used by the batch
+    void initBatchData();
+    // Initializes the per-instance buffer next to the quad VAO
+    void initInstanceData();
+    // Uploads and draws instances with the instance shader
+    void drawInstances(const SpriteInstance *instances, unsigned int count);
+    // Flushes the pending batch if the next sprite can't join it
+    void prepareBatch(const Texture2D &texture);
 };
 
 #endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <iostream>
 #include "Vertex.h"
 #include "util/Util.h"
+#include "GLState.h"
 
 namespace VO {
 
@@ -86,6 +87,7 @@ namespace VO {
 
     VAO::~VAO() {
         if (id) {
+            GLState::ForgetVertexArray(id);
             glDeleteVertexArrays(1, &id);
         }
     }
@@ -100,6 +102,7 @@ namespace VO {
     VAO& VAO::operator=(VAO &&other) noexcept {
         if (this != &other) {
             if (id) {
+                GLState::ForgetVertexArray(id);
                 glDeleteVertexArrays(1, &id);
             }
             id = std::exchange(other.id, 0);
@@ -118,7 +121,7 @@ namespace VO {
     }
 
     int VAO::bind() const {
-        glBindVertexArray(id);
+        GLState::BindVertexArray(id);
         return Indices.size();
     }
 
@@ -158,7 +161,7 @@ namespace VO {
     }
 
     void VAO::unbind() const {
-        glBindVertexArray(0);
+        GLState::BindVertexArray(0);
     }
 
     EBO::~EBO() {
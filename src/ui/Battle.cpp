@@ -148,10 +148,10 @@ void Battle::UpdateBattleLogic([[maybe_unused]] float dt) {
 }
 
 
-void Battle::Render(SpriteRenderer& renderer) {
+void Battle::Render(RenderQueue& queue) {
     if (!isActive) return;
 
-    RenderBattleScene(renderer);
+    RenderBattleScene(queue);
 }
 float Battle::GetTypeModifier(const std::string& attackType, const std::string& defenderType) {
     if ((attackType == "Water" && defenderType == "Insect") ||
@@ -167,7 +167,7 @@ float Battle::GetTypeModifier(const std::string& attackType, const std::string&
 }
 
 
-void Battle::RenderBattleScene(SpriteRenderer& renderer) {
+void Battle::RenderBattleScene(RenderQueue& queue) {
     // Render battle background (if you have one)
     // renderer.DrawSprite(backgroundTexture, glm::vec2(0.0f), glm::vec2(viewportWidth, viewportHeight));
 
@@ -175,14 +175,14 @@ void Battle::RenderBattleScene(SpriteRenderer& renderer) {
     if (enemyCharacter && enemyCharacter->isVisible) {
         enemyCharacter->Position = enemyPosition;
         enemyCharacter->Size = glm::vec2(300.0f, 300.0f);
-        enemyCharacter->Draw(renderer);
+        enemyCharacter->Submit(queue);
     }
 
     // Render player's monster
     if (battleMonster && battleMonster->isVisible) {
         battleMonster->Position = playerPosition;
         battleMonster->Mirror = true;
-        battleMonster->Draw(renderer);
+        battleMonster->Submit(queue);
         battleMonster->Mirror = false;
     }
 }
@@ -20,7 +20,7 @@ public:
     ~Battle() = default;
 
     void Update(float dt);
-    void Render(SpriteRenderer& renderer);
+    void Render(RenderQueue& queue);
     void RenderUI();
     
     bool IsActive() const { return isActive; }
@@ -47,7 +47,7 @@ private:
     void ApplyStatusEffect(StatusEffect effect, bool isPlayer);
     void HandleStatusEffects(BattleStats& stats);
     void UpdateBattleLogic(float dt);
-    void RenderBattleScene(SpriteRenderer& renderer);
+    void RenderBattleScene(RenderQueue& queue);
     void RenderBattleMenu();
     void RenderHealthBars();
     void RenderMoveSelection();
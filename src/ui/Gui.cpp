@@ -1,4 +1,5 @@
 #include "Gui.h"
+#include "render/GLState.h"
 
 void Gui::Init(GLFWwindow *window){
     // Setup ImGui context with docking and multi-window support
@@ -65,6 +66,8 @@ void Gui::Render() {
     // Rendering
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    // the backend restores most of what it touches, but not everything we shadow
+    GLState::Invalidate();
     #ifdef WINDOWS
     ImGuiIO &io = ImGui::GetIO();
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
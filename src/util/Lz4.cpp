@@ -0,0 +1,124 @@
+#include "Lz4.h"
+
+#include <cstring>
+
+namespace
+{
+    const size_t MIN_MATCH = 4;
+    // the format ends every block with at least this many literals...
+    const size_t LAST_LITERALS = 5;
+    // ...and no match may start closer than this to the end
+    const size_t MATCH_LIMIT = 12;
+    const size_t MAX_OFFSET = 65535;
+    const unsigned int HASH_BITS = 12;
+
+    uint32_t read32(const uint8_t *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    void writeLength(std::vector<uint8_t> &out, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+            out.push_back(255);
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    void writeSequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t literalCount, size_t offset, size_t matchLength)
+    {
+        size_t match = matchLength >= MIN_MATCH ? matchLength - MIN_MATCH : 0;
+        out.push_back(static_cast<uint8_t>((literalCount < 15 ? literalCount : 15) << 4 | (match < 15 ? match : 15)));
+        if (literalCount >= 15)
+            writeLength(out, literalCount - 15);
+        out.insert(out.end(), literals, literals + literalCount);
+        if (matchLength == 0)
+            return;
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match >= 15)
+            writeLength(out, match - 15);
+    }
+
+    bool readLength(const uint8_t *src, size_t size, size_t &ip, size_t &length)
+    {
+        uint8_t byte;
+        do {
+            if (ip >= size)
+                return false;
+            byte = src[ip++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+}
+
+std::vector<uint8_t> lz4Compress(const void *source, size_t size)
+{
+    const uint8_t *src = static_cast<const uint8_t *>(source);
+    std::vector<uint8_t> out;
+    out.reserve(size + size / 255 + 16);
+
+    size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        std::vector<int64_t> table(size_t(1) << HASH_BITS, -1);
+        size_t ip = 0;
+        while (ip < size - MATCH_LIMIT) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            int64_t candidate = table[hash];
+            table[hash] = static_cast<int64_t>(ip);
+            if (candidate < 0 || ip - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+                ++ip;
+                continue;
+            }
+            size_t length = MIN_MATCH;
+            while (ip + length < size - LAST_LITERALS && src[candidate + length] == src[ip + length])
+                ++length;
+            writeSequence(out, src + anchor, ip - anchor, ip - candidate, length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+    writeSequence(out, src + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+bool lz4Decompress(const void *source, size_t size, void *destination, size_t dstSize)
+{
+    const uint8_t *src = static_cast<const uint8_t *>(source);
+    uint8_t *dst = static_cast<uint8_t *>(destination);
+    size_t ip = 0, op = 0;
+    while (ip < size) {
+        uint8_t token = src[ip++];
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(src, size, ip, literals))
+            return false;
+        if (literals > size - ip || literals > dstSize - op)
+            return false;
+        std::memcpy(dst + op, src + ip, literals);
+        ip += literals;
+        op += literals;
+        // the last sequence has no match
+        if (ip == size)
+            break;
+
+        if (size - ip < 2)
+            return false;
+        size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op)
+            return false;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(src, size, ip, length))
+            return false;
+        length += MIN_MATCH;
+        if (length > dstSize - op)
+            return false;
+        // matches may overlap their own output, so copy forwards byte by byte
+        for (size_t i = 0; i < length; ++i, ++op)
+            dst[op] = dst[op - offset];
+    }
+    return op == dstSize;
+}
@@ -0,0 +1,16 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compression in the LZ4 block format (no frame header, no checksum):
+// greedy matching with a small hash table, fast to decode and good enough
+// for text assets. The decoder checks every length and offset against
+// both buffers, so a corrupt block fails instead of overrunning.
+std::vector<uint8_t> lz4Compress(const void *source, size_t size);
+// dstSize must be the exact uncompressed size
+bool lz4Decompress(const void *source, size_t size, void *destination, size_t dstSize);
+
+#endif
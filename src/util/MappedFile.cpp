@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    this->Close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        this->Close();
+        std::swap(this->data, other.data);
+        std::swap(this->size, other.size);
+        std::swap(this->open, other.open);
+#ifdef _WIN32
+        std::swap(this->file, other.file);
+        std::swap(this->mapping, other.mapping);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string &path)
+{
+    this->Close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        return false;
+    }
+    this->file = handle;
+    this->size = static_cast<size_t>(fileSize.QuadPart);
+    this->open = true;
+    if (this->size == 0)
+        return true;
+
+    HANDLE map = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!map) {
+        this->Close();
+        return false;
+    }
+    this->mapping = map;
+    this->data = static_cast<const unsigned char *>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+    if (!this->data) {
+        this->Close();
+        return false;
+    }
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    this->size = static_cast<size_t>(info.st_size);
+    this->open = true;
+    if (this->size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void *mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        this->size = 0;
+        this->open = false;
+        return false;
+    }
+    this->data = static_cast<const unsigned char *>(mapped);
+    return true;
+#endif
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (this->data)
+        UnmapViewOfFile(this->data);
+    if (this->mapping)
+        CloseHandle(this->mapping);
+    if (this->file)
+        CloseHandle(this->file);
+    this->mapping = nullptr;
+    this->file = nullptr;
+#else
+    if (this->data)
+        munmap(const_cast<unsigned char *>(this->data), this->size);
+#endif
+    this->data = nullptr;
+    this->size = 0;
+    this->open = false;
+}
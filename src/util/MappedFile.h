@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as
+// the object; moving it hands the mapping over.
+class MappedFile
+{
+public:
+    MappedFile() { }
+    ~MappedFile();
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // maps the file, closing whatever was mapped before; false if the file
+    // can't be opened (an empty file opens fine but has no data)
+    bool Open(const std::string &path);
+    void Close();
+
+    bool IsOpen() const { return open; }
+    const unsigned char *Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const unsigned char *data = nullptr;
+    size_t               size = 0;
+    bool                 open = false;
+#ifdef _WIN32
+    void                *file = nullptr;
+    void                *mapping = nullptr;
+#endif
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "StringArena.h"
+
+#include <algorithm>
+#include <cstring>
+
+const char *StringArena::Store(std::string_view string)
+{
+    size_t size = string.size() + 1;
+    if (this->blocks.empty() || this->offset + size > this->capacity) {
+        // oversized strings get a block of their own
+        this->capacity = std::max(this->blockSize, size);
+        this->blocks.emplace_back(new char[this->capacity]);
+        this->offset = 0;
+        this->reserved += this->capacity;
+    }
+    char *copy = this->blocks.back().get() + this->offset;
+    std::memcpy(copy, string.data(), string.size());
+    copy[string.size()] = '\0';
+    this->offset += size;
+    this->used += size;
+    return copy;
+}
+
+const char *StringArena::Intern(std::string_view string)
+{
+    auto it = this->interned.find(string);
+    if (it != this->interned.end())
+        return it->data();
+    const char *copy = this->Store(string);
+    this->interned.insert(std::string_view(copy, string.size()));
+    return copy;
+}
+
+void StringArena::Clear()
+{
+    this->blocks.clear();
+    this->interned.clear();
+    this->offset = this->capacity = 0;
+    this->used = this->reserved = 0;
+}
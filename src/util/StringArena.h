@@ -0,0 +1,40 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Append-only storage for strings that have to outlive the std::string they
+// were built in. Strings are copied into large blocks and never move, so the
+// returned pointers stay valid until Clear(). Intern() hands out one copy
+// per distinct string, so storing the same path twice costs nothing.
+class StringArena
+{
+public:
+    explicit StringArena(size_t blockSize = 16 * 1024) : blockSize(blockSize) { }
+    StringArena(const StringArena &) = delete;
+    StringArena &operator=(const StringArena &) = delete;
+
+    // copies the string (null terminated) and returns the copy
+    const char *Store(std::string_view string);
+    // returns the existing copy of an equal string, or stores a new one
+    const char *Intern(std::string_view string);
+    // frees every string at once; all pointers handed out become invalid
+    void Clear();
+
+    // bytes handed out, and bytes allocated for blocks
+    size_t Used() const { return used; }
+    size_t Reserved() const { return reserved; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::unordered_set<std::string_view> interned;
+    size_t blockSize;
+    size_t offset = 0, capacity = 0;
+    size_t used = 0, reserved = 0;
+};
+
+#endif
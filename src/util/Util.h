@@ -6,6 +6,7 @@
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <cstdint>
 #include "asset/Texture2D.h"
 
 // Function prototypes
@@ -37,4 +38,8 @@ std::vector<Value> ConvertMapToList(const std::map<Key, Value>& inputMap) {
 // Function to convert a char to lowercase
 void lower(char *str);
 
+// 64-bit FNV-1a hash of a block of memory; pass a previous result as seed
+// to hash data in pieces
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 14695981039346656037ull);
+
 #endif // util_h
\ No newline at end of file
@@ -0,0 +1,329 @@
+// neuromonsters-cook: turns the source asset folders into what the game
+// loads fastest, so none of it happens on the player's machine:
+//
+//     textures/*.png|jpg   -> the image plus <name>.tex (decoded, mip chain);
+//                             only the .tex goes into the pack
+//     levels/*.lvl         -> levels/<name>.lvlb
+//     shaders/**           -> comment-stripped copies
+//     everything above     -> assets.pak
+//
+// usage: neuromonsters-cook <source dir> <output dir> [-j threads] [--force] [--no-pack]
+//
+// A manifest in the output dir records the content hash of every input;
+// inputs whose hash didn't change (and whose outputs still exist) are
+// skipped. Independent inputs are cooked in parallel.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "asset/AssetPack.h"
+#include "asset/CookedTexture.h"
+#include "asset/LevelFile.h"
+#include "util/MappedFile.h"
+#include "util/Util.h"
+
+namespace fs = std::filesystem;
+
+// bump when an output format or a cooking step changes, to re-cook everything
+static const uint64_t COOK_VERSION = 2;
+static const char *MANIFEST = "cook-manifest.txt";
+static const char *PACK = "assets.pak";
+
+enum class Kind { Texture, Level, Shader };
+
+struct Input
+{
+    Kind        kind;
+    std::string name;   // relative to the source dir, '/' separated
+    uint64_t    hash = 0;
+};
+
+static std::mutex outputMutex;
+
+static void report(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+static std::string relativeName(const fs::path &path, const fs::path &root)
+{
+    return fs::relative(path, root).generic_string();
+}
+
+// files the game will look for, relative to the output dir
+static std::vector<std::string> outputsFor(const Input &input)
+{
+    switch (input.kind) {
+    case Kind::Texture:
+        return { input.name, input.name + ".tex" };
+    case Kind::Level:
+        return { fs::path(input.name).replace_extension(".lvlb").generic_string() };
+    case Kind::Shader:
+    default:
+        return { input.name };
+    }
+}
+
+static std::vector<Input> collect(const fs::path &source)
+{
+    std::vector<Input> inputs;
+    std::error_code error;
+    auto scan = [&](const char *folder, Kind kind, auto accept) {
+        for (auto it = fs::recursive_directory_iterator(source / folder, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file() && accept(it->path()))
+                inputs.push_back({ kind, relativeName(it->path(), source) });
+        }
+        error.clear();
+    };
+    scan("textures", Kind::Texture, [](const fs::path &path) {
+        return path.extension() == ".png" || path.extension() == ".jpg" || path.extension() == ".jpeg";
+    });
+    scan("levels", Kind::Level, [](const fs::path &path) { return path.extension() == ".lvl"; });
+    scan("shaders", Kind::Shader, [](const fs::path &) { return true; });
+    std::sort(inputs.begin(), inputs.end(), [](const Input &a, const Input &b) { return a.name < b.name; });
+    return inputs;
+}
+
+static std::map<std::string, uint64_t> readManifest(const fs::path &path)
+{
+    std::map<std::string, uint64_t> manifest;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        // "<16 hex digits> <name>"
+        if (line.size() < 18)
+            continue;
+        manifest[line.substr(17)] = std::stoull(line.substr(0, 16), nullptr, 16);
+    }
+    return manifest;
+}
+
+static bool writeManifest(const fs::path &path, const std::vector<Input> &inputs)
+{
+    std::ofstream file(path, std::ios::trunc);
+    for (const Input &input : inputs) {
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(input.hash));
+        file << hash << ' ' << input.name << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+static bool writeFile(const fs::path &path, const void *data, size_t size)
+{
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    return static_cast<bool>(file);
+}
+
+// Strips comments, trailing whitespace and blank lines and normalizes line
+// endings; comments above #version only leave blank lines, which are dropped,
+// so it stays the first line
+static std::string preprocessShader(const std::string &source)
+{
+    std::string code;
+    code.reserve(source.size());
+    bool block = false;
+    for (size_t i = 0; i < source.size(); ++i) {
+        char c = source[i];
+        char next = i + 1 < source.size() ? source[i + 1] : '\0';
+        if (block) {
+            if (c == '*' && next == '/') {
+                block = false;
+                ++i;
+            } else if (c == '\n') {
+                code += '\n';
+            }
+            continue;
+        }
+        if (c == '/' && next == '*') {
+            block = true;
+            ++i;
+        } else if (c == '/' && next == '/') {
+            while (i < source.size() && source[i] != '\n')
+                ++i;
+            code += '\n';
+        } else if (c != '\r') {
+            code += c;
+        }
+    }
+
+    std::string result;
+    std::istringstream lines(code);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t end = line.find_last_not_of(" \t");
+        if (end == std::string::npos)
+            continue;
+        result.append(line, 0, end + 1);
+        result += '\n';
+    }
+    return result;
+}
+
+static bool cookTexture(const fs::path &source, const fs::path &output, const Input &input, const MappedFile &file)
+{
+    int width, height, channels;
+    unsigned char *pixels = stbi_load_from_memory(file.Data(), static_cast<int>(file.Size()), &width, &height, &channels, 0);
+    if (!pixels) {
+        report("error: can't decode " + input.name);
+        return false;
+    }
+    // the loaders only handle RGB and RGBA; expand anything else to RGBA
+    if (channels != 3 && channels != 4) {
+        stbi_image_free(pixels);
+        pixels = stbi_load_from_memory(file.Data(), static_cast<int>(file.Size()), &width, &height, &channels, 4);
+        channels = 4;
+    }
+
+    fs::path image = output / input.name;
+    std::error_code error;
+    fs::create_directories(image.parent_path(), error);
+    fs::copy_file(source / input.name, image, fs::copy_options::overwrite_existing, error);
+    // the runtime checks a cooked texture against its image's size and mtime
+    fs::last_write_time(image, fs::last_write_time(source / input.name, error), error);
+    int64_t time = static_cast<int64_t>(fs::last_write_time(image, error).time_since_epoch().count());
+
+    std::vector<unsigned char> cooked = CookedTexture::Cook(pixels, width, height, channels, file.Size(), time,
+                                                            hashBytes(file.Data(), file.Size()));
+    stbi_image_free(pixels);
+    return writeFile(output / (input.name + ".tex"), cooked.data(), cooked.size());
+}
+
+static bool cook(const fs::path &source, const fs::path &output, const Input &input, const MappedFile &file)
+{
+    switch (input.kind) {
+    case Kind::Texture:
+        return cookTexture(source, output, input, file);
+    case Kind::Level: {
+        fs::path target = output / outputsFor(input)[0];
+        std::error_code error;
+        fs::create_directories(target.parent_path(), error);
+        return LevelFile::Convert((source / input.name).string(), target.string());
+    }
+    case Kind::Shader:
+    default: {
+        std::string code = preprocessShader(std::string(reinterpret_cast<const char *>(file.Data()), file.Size()));
+        return writeFile(output / input.name, code.data(), code.size());
+    }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> paths;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false, pack = true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--force") == 0)
+            force = true;
+        else if (std::strcmp(argv[i], "--no-pack") == 0)
+            pack = false;
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.size() != 2) {
+        std::cerr << "usage: " << argv[0] << " <source dir> <output dir> [-j threads] [--force] [--no-pack]" << std::endl;
+        return 2;
+    }
+    fs::path source = paths[0], output = paths[1];
+    std::error_code error;
+    fs::create_directories(output, error);
+
+    std::vector<Input> inputs = collect(source);
+    std::map<std::string, uint64_t> manifest = force ? std::map<std::string, uint64_t>() : readManifest(output / MANIFEST);
+
+    std::atomic<size_t> next(0);
+    std::atomic<unsigned int> cooked(0), skipped(0), failed(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < inputs.size(); i = next++) {
+            Input &input = inputs[i];
+            MappedFile file;
+            if (!file.Open((source / input.name).string())) {
+                report("error: can't read " + input.name);
+                failed++;
+                continue;
+            }
+            input.hash = hashBytes(file.Data(), file.Size(), hashBytes(&COOK_VERSION, sizeof(COOK_VERSION)));
+
+            auto previous = manifest.find(input.name);
+            bool upToDate = previous != manifest.end() && previous->second == input.hash;
+            for (const std::string &out : outputsFor(input))
+                upToDate = upToDate && fs::exists(output / out);
+            if (upToDate) {
+                skipped++;
+                continue;
+            }
+
+            if (cook(source, output, input, file)) {
+                report("cooked " + input.name);
+                cooked++;
+            } else {
+                // forget the hash so the next run tries again
+                input.hash = 0;
+                failed++;
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int i = 0; i < std::min<size_t>(threads, std::max<size_t>(inputs.size(), 1)); ++i)
+        pool.emplace_back(worker);
+    for (std::thread &thread : pool)
+        thread.join();
+
+    // outputs of inputs that are gone
+    unsigned int removed = 0;
+    for (const auto &entry : manifest) {
+        bool present = std::any_of(inputs.begin(), inputs.end(), [&](const Input &input) { return input.name == entry.first; });
+        if (present)
+            continue;
+        Input gone = { entry.first.compare(0, 9, "textures/") == 0 ? Kind::Texture
+                     : entry.first.compare(0, 7, "levels/") == 0 ? Kind::Level : Kind::Shader, entry.first };
+        for (const std::string &out : outputsFor(gone))
+            fs::remove(output / out, error);
+        removed++;
+    }
+    writeManifest(output / MANIFEST, inputs);
+
+    if (pack && (cooked > 0 || removed > 0 || !fs::exists(output / PACK))) {
+        std::vector<std::pair<std::string, std::string>> files;
+        for (const Input &input : inputs) {
+            for (const std::string &out : outputsFor(input)) {
+                // the game reads a packed texture from its cooked copy; the
+                // image is only kept loose, for TextureCache's source checks
+                if (input.kind == Kind::Texture && out == input.name && fs::exists(output / (out + ".tex")))
+                    continue;
+                if (fs::exists(output / out))
+                    files.push_back({ out, (output / out).string() });
+            }
+        }
+        if (!AssetPack::Write((output / PACK).string(), files)) {
+            failed++;
+        } else {
+            report("packed " + std::to_string(files.size()) + " files into " + PACK);
+        }
+    }
+
+    std::cout << inputs.size() << " inputs, " << cooked << " cooked, "
+              << skipped << " up to date, " << failed << " failed" << std::endl;
+    return failed > 0 ? 1 : 0;
+}